@@ -1,14 +1,46 @@
 #pragma once
+#include "meta/details/BitStorage.h"
+
 #include <cinttypes>
 #include <initializer_list>
+#include <limits>
 #include <type_traits>
 
 namespace bitnumber {
 
+// invalid prototype is required for HasMaxBit to compile
+constexpr auto maxBit() -> void;
+
+// declare `constexpr auto maxBit(Enum) -> Enum` next to your enum to name its largest bit number
+// Flags<Enum> then uses the smallest unsigned type that holds all bits instead of uint64_t
+template<class, class = void>
+struct HasMaxBit : std::false_type {};
+
+template<class T>
+struct HasMaxBit<T, std::void_t<decltype(maxBit(std::declval<T>()))>> : std::true_type {};
+
+template<class T>
+constexpr auto hasMaxBit = HasMaxBit<T>::value;
+
+template<class T>
+constexpr auto selectBitType() {
+    if constexpr (hasMaxBit<T>) {
+        constexpr auto bits = 1 + static_cast<size_t>(maxBit(T{}));
+        static_assert(bits <= 64, "bit numbers beyond 63 do not fit any BitType");
+        return meta::details::SelectBitWord<bits>();
+    }
+    else {
+        return uint64_t{};
+    }
+}
+
+template<class T>
+using BitTypeFor = decltype(selectBitType<T>());
+
 #define ENABLE_BITNUMBER_FLAGS_OP(T)                                                                                   \
     constexpr auto operator|(T::EnumType e1, T::EnumType e2) noexcept->T { return T(e1) | e2; }
 
-template<class T, class V = uint64_t>
+template<class T, class V = BitTypeFor<T>>
 struct Flags {
     using This = Flags;
     static_assert(std::is_enum_v<T>, "flags only works for enums!");
@@ -16,9 +48,11 @@ struct Flags {
     using EnumType = T;
     using ValueType = std::underlying_type_t<T>;
     using BitType = V;
+    static_assert(std::is_unsigned_v<BitType>, "BitType has to be unsigned");
+    static constexpr auto bitWidth = std::numeric_limits<BitType>::digits;
 
     constexpr Flags(T v) noexcept
-        : Flags(BitType{1} << static_cast<ValueType>(v)) {}
+        : Flags(static_cast<BitType>(BitType{1} << static_cast<ValueType>(v))) {}
 
     template<class... Args>
     constexpr Flags(T v, Args... args) noexcept
@@ -36,6 +70,12 @@ struct Flags {
     constexpr bool operator==(const This &f) const noexcept { return v == f.v; }
     constexpr bool operator!=(const This &f) const noexcept { return v != f.v; }
 
+    // total order of the BitType value
+    constexpr bool operator<(const This &f) const noexcept { return v < f.v; }
+    constexpr bool operator>(const This &f) const noexcept { return f < *this; }
+    constexpr bool operator<=(const This &f) const noexcept { return !(f < *this); }
+    constexpr bool operator>=(const This &f) const noexcept { return !(*this < f); }
+
     template<class B>
     constexpr bool operator[](T t) const noexcept {
         return (v & This{t}.v) != BitType{};
@@ -62,36 +102,36 @@ struct Flags {
 
     constexpr static auto resetAll() noexcept -> This { return Flags{}; }
 
-    constexpr auto set(This b) const noexcept -> This { return This{v | b.v}; }
+    constexpr auto set(This b) const noexcept -> This { return This{static_cast<BitType>(v | b.v)}; }
     template<class... Args>
     constexpr auto set(T b, Args... args) const noexcept -> This {
         return set(build(b, args...));
     }
 
-    constexpr auto reset(This b) const noexcept -> This { return This{v & ~b.v}; }
+    constexpr auto reset(This b) const noexcept -> This { return This{static_cast<BitType>(v & ~b.v)}; }
     template<class... Args>
     constexpr auto reset(T b, Args... args) const noexcept -> This {
         return reset(build(b, args...));
     }
 
-    constexpr auto flip(This b) const noexcept -> This { return This{v ^ b.v}; }
+    constexpr auto flip(This b) const noexcept -> This { return This{static_cast<BitType>(v ^ b.v)}; }
     template<class... Args>
     constexpr auto flip(T b, Args... args) const noexcept -> This {
         return flip(build(b, args...));
     }
 
-    constexpr auto mask(This b) const noexcept -> This { return This{v & b.v}; }
+    constexpr auto mask(This b) const noexcept -> This { return This{static_cast<BitType>(v & b.v)}; }
     template<class... Args>
     constexpr auto mask(T b, Args... args) const noexcept -> This {
         return mask(build(b, args...));
     }
 
-    constexpr This operator|(const This &f) const noexcept { return {v | f.v}; }
+    constexpr This operator|(const This &f) const noexcept { return This{static_cast<BitType>(v | f.v)}; }
 
-    constexpr Flags clear(const Flags &f) const noexcept { return {v & ~f.v}; }
+    constexpr Flags clear(const Flags &f) const noexcept { return Flags{static_cast<BitType>(v & ~f.v)}; }
 
     template<class... Args>
-    constexpr bool clear(const T &v, Args &&... args) const noexcept {
+    constexpr auto clear(const T &v, Args &&... args) const noexcept -> This {
         return clear(build(v, args...));
     }
 
@@ -123,13 +163,8 @@ struct Flags {
 
     template<class F>
     constexpr void each_set(F &&f) const noexcept {
-        auto vt = ValueType{};
-        while (true) {
-            const auto t = static_cast<T>(vt);
-            const auto ft = Flags{t};
-            if (ft.v > v) break;
-            if (any(t)) f(t);
-            vt++;
+        for (auto vt = 0; vt < bitWidth && (v >> vt) != 0; vt++) {
+            if ((v >> vt) & 1) f(static_cast<T>(vt));
         }
     }
 
@@ -146,6 +181,19 @@ private:
     BitType v{};
 };
 
+namespace test {
+
+enum class TE { n1, n2, n3 = 4 };
+enum class TM { n1, n2, n3 = 12 };
+constexpr auto maxBit(TM) -> TM { return TM::n3; }
+
+static_assert(sizeof(Flags<TE>) == sizeof(uint64_t), "unknown range keeps uint64_t");
+static_assert(sizeof(Flags<TM>) == sizeof(uint16_t), "13 bits should fit into two bytes");
+static_assert(alignof(Flags<TM>) == alignof(uint16_t), "");
+static_assert(Flags<TM>{TM::n3}.any(TM::n3), "");
+
+} // namespace test
+
 template<class Out, class T>
 auto operator<<(Out &out, Flags<T> f)
     -> std::enable_if_t<std::is_same_v<decltype(out << std::declval<T>()), decltype(out)>, decltype(out)> //
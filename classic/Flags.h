@@ -36,6 +36,12 @@ struct Flags {
     constexpr bool operator==(This f) const noexcept { return v == f.v; }
     constexpr bool operator!=(This f) const noexcept { return v != f.v; }
 
+    // total order of the value read as unsigned, so a sign bit flag sorts last
+    constexpr bool operator<(This f) const noexcept { return unsignedValue() < f.unsignedValue(); }
+    constexpr bool operator>(This f) const noexcept { return f < *this; }
+    constexpr bool operator<=(This f) const noexcept { return !(f < *this); }
+    constexpr bool operator>=(This f) const noexcept { return !(*this < f); }
+
     constexpr bool operator[](Enum t) const noexcept { return (v & t) != 0; }
 
     constexpr bool all(This f) const noexcept { return (v & f.v) == f.v; }
@@ -125,6 +131,8 @@ private:
     constexpr Flags(Value v) noexcept
         : v(v) {}
 
+    constexpr auto unsignedValue() const noexcept { return static_cast<std::make_unsigned_t<Value>>(v); }
+
     template<class... Args>
     static constexpr auto build(Args... args) noexcept -> Flags {
         return Flags{(... | static_cast<Value>(args))};
@@ -0,0 +1,7 @@
+#include "FlagsCodec.h"
+
+namespace codec {
+
+// TODO
+
+} // namespace codec
@@ -0,0 +1,382 @@
+#pragma once
+#include "columnar/FlagsVector.h"
+#include "meta/details/Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace codec {
+
+// Payload of an encoded batch
+enum class Mode : uint8_t {
+    Packed, // every value takes exactly bitCount bits
+    Sparse, // every value is the list of its set flags as varints
+};
+
+namespace details {
+
+using meta::details::fnv1a;
+
+constexpr auto varintBytes(uint64_t v) noexcept -> size_t {
+    auto r = size_t{1};
+    for (; v >= 0x80; v >>= 7) r++;
+    return r;
+}
+
+constexpr auto zigzag(int64_t v) noexcept -> uint64_t {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+constexpr auto unzigzag(uint64_t v) noexcept -> int64_t {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Little endian loads and stores, independent of the byte order of the machine
+inline void storeLE(unsigned char *p, uint64_t v, size_t bytes) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(p, &v, bytes);
+#else
+    for (auto i = size_t{}; i < bytes; i++) p[i] = static_cast<unsigned char>(v >> (8 * i));
+#endif
+}
+inline auto loadLE(const unsigned char *p, size_t bytes) noexcept -> uint64_t {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    auto v = uint64_t{};
+    std::memcpy(&v, p, bytes);
+    return v;
+#else
+    auto v = uint64_t{};
+    for (auto i = size_t{}; i < bytes; i++) v |= uint64_t{p[i]} << (8 * i);
+    return v;
+#endif
+}
+
+// Bounds checked varint writer and reader, stop at the end instead of overrunning it
+struct VarintWriter {
+    unsigned char *p;
+    unsigned char *end;
+
+    bool put(uint64_t v) noexcept {
+        for (; v >= 0x80; v >>= 7) {
+            if (p == end) return false;
+            *p++ = static_cast<unsigned char>(v | 0x80);
+        }
+        if (p == end) return false;
+        *p++ = static_cast<unsigned char>(v);
+        return true;
+    }
+};
+
+struct VarintReader {
+    const unsigned char *p;
+    const unsigned char *end;
+
+    bool get(uint64_t &v) noexcept {
+        v = 0;
+        for (auto shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            const auto b = *p++;
+            v |= uint64_t{b & 0x7fu} << shift;
+            if (b < 0x80) return true;
+        }
+        return false;
+    }
+};
+
+// Flags as an array of 64 bit words, flag index b is bit b % 64 of word b / 64
+template<class F>
+struct ValueWords {
+    using Word = decltype(columnar::details::selectPlaneWord<sizeof(F)>());
+    static constexpr auto wordCount = sizeof(F) / sizeof(Word);
+    static constexpr auto count = (sizeof(F) + 7) / 8;
+    using Words = std::array<uint64_t, count>;
+
+    static auto of(const F &f) noexcept -> Words {
+        auto w = std::array<Word, wordCount>{};
+        std::memcpy(w.data(), &f, sizeof(F));
+        auto r = Words{};
+        if constexpr (sizeof(Word) == sizeof(uint64_t))
+            for (auto k = size_t{}; k < wordCount; k++) r[k] = w[k];
+        else
+            r[0] = static_cast<std::make_unsigned_t<Word>>(w[0]);
+        return r;
+    }
+    static auto to(const Words &r) noexcept -> F {
+        auto w = std::array<Word, wordCount>{};
+        if constexpr (sizeof(Word) == sizeof(uint64_t))
+            for (auto k = size_t{}; k < wordCount; k++) w[k] = r[k];
+        else
+            w[0] = static_cast<Word>(r[0]);
+        auto f = F{};
+        std::memcpy(static_cast<void *>(&f), w.data(), sizeof(F));
+        return f;
+    }
+};
+
+} // namespace details
+
+// Binary codec for batches of flags of any flavour
+//
+// Layout of a batch, all integers little endian:
+// * 24 byte header: magic "FLG1", version, mode, bitCount (16 bit), schema fingerprint (64 bit), value count (64 bit)
+// * Packed: the values as one bit stream, value i takes the bits [i * bitCount, (i + 1) * bitCount),
+//   flag index b of a value is bit b of its slot, bit n of the stream is bit n % 8 of byte n / 8
+// * Sparse: per value a varint with the number of set flags, the first index as zigzag varint of the difference
+//   to the first index of the previous value and the following indices as varints of the gap minus one
+//
+// The fingerprint hashes bitCount and the flag names, it does not depend on the compiler or the machine.
+// encode() and decode() work on caller provided memory and never allocate.
+//
+//     auto codec = codec::FlagsCodec<Animals>{{"Cat", "Dog", "Wolf"}};
+//     auto bytes = codec.encode(animals, codec::Mode::Sparse);
+//     auto back = codec.decode(bytes); // nullopt for another schema or broken data
+template<class F>
+struct FlagsCodec {
+    using This = FlagsCodec;
+    using Flags = F;
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+
+    static constexpr auto bitCount = columnar::details::FlagCount<F>::value;
+    static constexpr auto headerSize = size_t{24};
+    static constexpr auto magic = uint32_t{0x31474c46}; // "FLG1"
+    static constexpr auto version = uint8_t{1};
+    static_assert(bitCount < 65536, "bitCount has to fit the header");
+
+    // Fingerprint of bitCount and the names of the flags in index order
+    static auto schemaFingerprint(const std::vector<std::string> &names = {}) noexcept -> uint64_t {
+        auto h = details::fnv1a("flags17 codec");
+        const char bits[2] = {static_cast<char>(bitCount & 0xff), static_cast<char>(bitCount >> 8)};
+        h = details::fnv1a({bits, 2}, h);
+        for (const auto &n : names) h = details::fnv1a({n.c_str(), n.size() + 1}, h);
+        return h;
+    }
+
+    explicit FlagsCodec(const std::vector<std::string> &names = {}) noexcept
+        : schema(schemaFingerprint(names)) {}
+
+    auto fingerprint() const noexcept -> uint64_t { return schema; }
+
+    // Bytes that always suffice for n values
+    static constexpr auto max_encoded_size(size_t n, Mode mode) noexcept -> size_t {
+        if (mode == Mode::Packed) return headerSize + (n * bitCount + 7) / 8;
+        return headerSize + n * (details::varintBytes(bitCount) + bitCount * details::varintBytes(2 * bitCount));
+    }
+
+    // Exact bytes of encode(values, n, mode)
+    static auto encoded_size(const F *values, size_t n, Mode mode) noexcept -> size_t {
+        if (mode == Mode::Packed) return max_encoded_size(n, mode);
+        auto r = headerSize;
+        sparseCodes(values, n, [&](uint64_t code) {
+            r += details::varintBytes(code);
+            return true;
+        });
+        return r;
+    }
+
+    // Writes the batch to out, returns the number of bytes or 0 if capacity does not suffice
+    auto encode(const F *values, size_t n, Mode mode, unsigned char *out, size_t capacity) const noexcept -> size_t {
+        if (capacity < headerSize) return 0;
+        writeHeader(out, mode, n);
+        const auto size = mode == Mode::Packed ? encodePacked(values, n, out + headerSize, capacity - headerSize)
+                                               : encodeSparse(values, n, out + headerSize, capacity - headerSize);
+        return size == npos ? 0 : headerSize + size;
+    }
+
+    // Number of values of an encoded batch, nullopt if the header is broken or has another schema
+    auto count(const unsigned char *data, size_t size) const noexcept -> std::optional<size_t> {
+        if (size < headerSize) return std::nullopt;
+        if (details::loadLE(data, 4) != magic || data[4] != version || data[5] > uint8_t(Mode::Sparse))
+            return std::nullopt;
+        if (details::loadLE(data + 6, 2) != bitCount || details::loadLE(data + 8, 8) != schema) return std::nullopt;
+        const auto n = details::loadLE(data + 16, 8);
+        if (n > (size - headerSize) * 8) return std::nullopt; // every value takes at least a bit
+        return static_cast<size_t>(n);
+    }
+
+    // Decodes a whole batch to out, returns the number of values
+    // nullopt if the batch has another schema, is truncated, has trailing bytes or does not fit capacity.
+    auto decode(const unsigned char *data, size_t size, F *out, size_t capacity) const noexcept
+        -> std::optional<size_t> {
+        const auto n = count(data, size);
+        if (!n || *n > capacity) return std::nullopt;
+        const auto ok = Mode{data[5]} == Mode::Packed ? decodePacked(data + headerSize, size - headerSize, out, *n)
+                                                      : decodeSparse(data + headerSize, size - headerSize, out, *n);
+        if (!ok) return std::nullopt;
+        return n;
+    }
+
+    auto encode(const std::vector<F> &values, Mode mode = Mode::Packed) const -> std::vector<unsigned char> {
+        auto r = std::vector<unsigned char>(encoded_size(values.data(), values.size(), mode));
+        encode(values.data(), values.size(), mode, r.data(), r.size());
+        return r;
+    }
+    auto decode(const std::vector<unsigned char> &bytes) const -> std::optional<std::vector<F>> {
+        const auto n = count(bytes.data(), bytes.size());
+        if (!n) return std::nullopt;
+        auto r = std::vector<F>(*n);
+        if (!decode(bytes.data(), bytes.size(), r.data(), r.size())) return std::nullopt;
+        return r;
+    }
+
+private:
+    using Words = typename details::ValueWords<F>::Words;
+    static constexpr auto npos = ~size_t{};
+    static constexpr auto wordCount = std::tuple_size_v<Words>;
+
+    static constexpr auto bitsIn(size_t k) noexcept -> size_t {
+        return bitCount - k * 64 < 64 ? bitCount - k * 64 : size_t{64};
+    }
+    static constexpr auto lowBits(size_t bits) noexcept -> uint64_t {
+        return bits >= 64 ? ~uint64_t{} : (uint64_t{1} << bits) - 1;
+    }
+
+    void writeHeader(unsigned char *out, Mode mode, size_t n) const noexcept {
+        details::storeLE(out, magic, 4);
+        out[4] = version;
+        out[5] = static_cast<uint8_t>(mode);
+        details::storeLE(out + 6, bitCount, 2);
+        details::storeLE(out + 8, schema, 8);
+        details::storeLE(out + 16, n, 8);
+    }
+
+    // 64 bit accumulator, full words are stored as they fill up
+    static auto encodePacked(const F *values, size_t n, unsigned char *out, size_t capacity) noexcept -> size_t {
+        const auto bytes = (n * bitCount + 7) / 8;
+        if (bytes > capacity) return npos;
+        if constexpr (bitCount % 8 == 0 && bitCount <= 64) {
+            // byte aligned values, one store each
+            for (auto i = size_t{}; i < n; i++)
+                details::storeLE(out + i * (bitCount / 8), details::ValueWords<F>::of(values[i])[0], bitCount / 8);
+            return bytes;
+        }
+        auto p = out;
+        auto acc = uint64_t{};
+        auto fill = size_t{};
+        for (auto i = size_t{}; i < n; i++) {
+            const auto w = details::ValueWords<F>::of(values[i]);
+            for (auto k = size_t{}; k < wordCount; k++) {
+                const auto bits = bitsIn(k);
+                const auto v = w[k] & lowBits(bits);
+                acc |= v << fill;
+                if (fill + bits >= 64) {
+                    details::storeLE(p, acc, 8);
+                    p += 8;
+                    acc = fill == 0 ? 0 : v >> (64 - fill);
+                    fill = fill + bits - 64;
+                }
+                else
+                    fill += bits;
+            }
+        }
+        details::storeLE(p, acc, static_cast<size_t>(out + bytes - p));
+        return bytes;
+    }
+
+    static bool decodePacked(const unsigned char *data, size_t size, F *out, size_t n) noexcept {
+        const auto bytes = (n * bitCount + 7) / 8;
+        if (size != bytes) return false;
+        if constexpr (bitCount % 8 == 0 && bitCount <= 64) {
+            for (auto i = size_t{}; i < n; i++)
+                out[i] = details::ValueWords<F>::to({details::loadLE(data + i * (bitCount / 8), bitCount / 8)});
+            return true;
+        }
+        auto p = data;
+        const auto end = data + bytes;
+        auto acc = uint64_t{};
+        auto fill = size_t{}; // bits left in acc
+        for (auto i = size_t{}; i < n; i++) {
+            auto w = Words{};
+            for (auto k = size_t{}; k < wordCount; k++) {
+                const auto bits = bitsIn(k);
+                if (fill >= bits) {
+                    w[k] = acc & lowBits(bits);
+                    acc = bits == 64 ? 0 : acc >> bits;
+                    fill -= bits;
+                    continue;
+                }
+                const auto chunk = std::min<size_t>(8, static_cast<size_t>(end - p));
+                const auto next = details::loadLE(p, chunk);
+                p += chunk;
+                w[k] = (acc | next << fill) & lowBits(bits);
+                const auto used = bits - fill; // bits taken from next
+                acc = used == 64 ? 0 : next >> used;
+                fill = chunk * 8 - used;
+            }
+            out[i] = details::ValueWords<F>::to(w);
+        }
+        return true;
+    }
+
+    // Calls put(code) for every varint of the sparse payload, stops once put returns false
+    template<class Put>
+    static bool sparseCodes(const F *values, size_t n, Put &&put) noexcept {
+        auto previous = int64_t{};
+        for (auto i = size_t{}; i < n; i++) {
+            auto w = details::ValueWords<F>::of(values[i]);
+            auto setCount = size_t{};
+            for (auto k = size_t{}; k < wordCount; k++) {
+                w[k] &= lowBits(bitsIn(k));
+                setCount += columnar::details::countSetBits(w[k]);
+            }
+            if (!put(setCount)) return false;
+            auto next = int64_t{-1}; // index after the last set flag, -1 before the first one
+            for (auto k = size_t{}; k < wordCount; k++) {
+                for (auto v = w[k]; v != 0; v &= v - 1) {
+                    const auto b = static_cast<int64_t>(k * 64 + columnar::details::countTrailingZeros(v));
+                    const auto code = next < 0 ? details::zigzag(b - previous) : static_cast<uint64_t>(b - next);
+                    if (!put(code)) return false;
+                    if (next < 0) previous = b;
+                    next = b + 1;
+                }
+            }
+        }
+        return true;
+    }
+
+    static auto encodeSparse(const F *values, size_t n, unsigned char *out, size_t capacity) noexcept -> size_t {
+        auto writer = details::VarintWriter{out, out + capacity};
+        if (!sparseCodes(values, n, [&](uint64_t code) { return writer.put(code); })) return npos;
+        return static_cast<size_t>(writer.p - out);
+    }
+
+    static bool decodeSparse(const unsigned char *data, size_t size, F *out, size_t n) noexcept {
+        auto reader = details::VarintReader{data, data + size};
+        auto previous = int64_t{};
+        for (auto i = size_t{}; i < n; i++) {
+            auto setCount = uint64_t{};
+            if (!reader.get(setCount) || setCount > bitCount) return false;
+            auto w = Words{};
+            auto b = uint64_t{};
+            for (auto j = uint64_t{}; j < setCount; j++) {
+                auto code = uint64_t{};
+                if (!reader.get(code)) return false;
+                if (j == 0) {
+                    const auto first = previous + details::unzigzag(code);
+                    if (first < 0) return false;
+                    b = static_cast<uint64_t>(first);
+                    previous = first;
+                }
+                else {
+                    if (code >= bitCount) return false;
+                    b += code + 1;
+                }
+                if (b >= bitCount) return false;
+                w[b / 64] |= uint64_t{1} << (b % 64);
+            }
+            out[i] = details::ValueWords<F>::to(w);
+        }
+        return reader.p == reader.end;
+    }
+
+private:
+    uint64_t schema{};
+};
+
+} // namespace codec
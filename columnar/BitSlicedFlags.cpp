@@ -0,0 +1,7 @@
+#include "BitSlicedFlags.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
@@ -0,0 +1,146 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace columnar {
+
+// Bit-sliced (transposed) flags column: one dense row bitmap per flag
+//
+// Row i of flag b is bit i % 64 of word i / 64 of slice(b).
+// A predicate only reads the bitmaps of the flags it mentions:
+//
+//     auto rows = sliced.bitmap_all_none(Animal::Cat | Animal::Dog, Animal::Wolf);   // cat & dog & ~wolf
+//
+// Build it from a FlagsVector for read-heavy phases and convert back with toVector() for writes.
+template<class F>
+struct BitSlicedFlags {
+    using This = BitSlicedFlags;
+    using Flags = F;
+    using Vector = FlagsVector<F>;
+    static constexpr auto flagCount = Vector::flagCount;
+
+    BitSlicedFlags() = default;
+    explicit BitSlicedFlags(const Vector &v)
+        : rows(v.size()) {
+        const auto words = v.bitmapWords();
+        for (auto &s : slices) s.assign(words, 0);
+        for (auto k = size_t{}; k < Vector::planeCount; k++) {
+            const auto plane = v.plane(k);
+            for (auto i = size_t{}; i < rows; i++) {
+                auto w = uint64_t{plane[i]};
+                while (w != 0) {
+                    const auto b = k * Vector::wordBits + details::countTrailingZeros(w);
+                    if (b < flagCount) slices[b][i / details::blockRows] |= uint64_t{1} << (i % details::blockRows);
+                    w &= w - 1;
+                }
+            }
+        }
+    }
+
+    auto toVector() const -> Vector {
+        auto r = Vector(rows);
+        for (auto b = size_t{}; b < flagCount; b++) {
+            auto plane = r.plane(b / Vector::wordBits);
+            const auto bit = static_cast<typename Vector::Word>(uint64_t{1} << (b % Vector::wordBits));
+            for (auto j = size_t{}; j < slices[b].size(); j++) {
+                for (auto w = slices[b][j]; w != 0; w &= w - 1)
+                    plane[j * details::blockRows + details::countTrailingZeros(w)] |= bit;
+            }
+        }
+        return r;
+    }
+
+    auto size() const noexcept -> size_t { return rows; }
+    bool empty() const noexcept { return rows == 0; }
+    auto bitmapWords() const noexcept -> size_t { return (rows + details::blockRows - 1) / details::blockRows; }
+
+    // raw row bitmap of flag b, bits past size() are cleared
+    auto slice(size_t b) const noexcept -> const uint64_t * { return slices[b].data(); }
+
+    // gathers one row from all slices
+    auto operator[](size_t i) const noexcept -> F {
+        auto w = std::array<uint64_t, (sizeof(F) + 7) / 8>{};
+        for (auto b = size_t{}; b < flagCount; b++)
+            w[b / 64] |= ((slices[b][i / details::blockRows] >> (i % details::blockRows)) & 1) << (b % 64);
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), w.data(), sizeof(F));
+        return r;
+    }
+
+    auto count_all(F mask) const noexcept -> size_t { return count_all_none(mask, F{}); }
+    auto count_any(F mask) const noexcept -> size_t { return rows - count_none(mask); }
+    auto count_none(F mask) const noexcept -> size_t { return count_all_none(F{}, mask); }
+    auto count_all_none(F all, F none) const noexcept -> size_t {
+        auto r = size_t{};
+        scan(all, none, [&](size_t, const uint64_t *chunk, size_t n) {
+            for (auto j = size_t{}; j < n; j++) r += details::countSetBits(chunk[j]);
+        });
+        return r;
+    }
+
+    // Writes one bit per row to out, out needs room for bitmapWords() words
+    void bitmap_all(F mask, uint64_t *out) const noexcept { bitmap_all_none(mask, F{}, out); }
+    void bitmap_any(F mask, uint64_t *out) const noexcept {
+        bitmap_all_none(F{}, mask, out);
+        for (auto j = size_t{}; j < bitmapWords(); j++) out[j] = ~out[j] & tailMask(j);
+    }
+    void bitmap_none(F mask, uint64_t *out) const noexcept { bitmap_all_none(F{}, mask, out); }
+    void bitmap_all_none(F all, F none, uint64_t *out) const noexcept {
+        scan(all, none, [&](size_t first, const uint64_t *chunk, size_t n) {
+            std::memcpy(out + first, chunk, n * sizeof(uint64_t));
+        });
+    }
+
+    auto bitmap_all(F mask) const -> std::vector<uint64_t> { return bitmap_all_none(mask, F{}); }
+    auto bitmap_any(F mask) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(bitmapWords());
+        bitmap_any(mask, r.data());
+        return r;
+    }
+    auto bitmap_none(F mask) const -> std::vector<uint64_t> { return bitmap_all_none(F{}, mask); }
+    auto bitmap_all_none(F all, F none) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(bitmapWords());
+        bitmap_all_none(all, none, r.data());
+        return r;
+    }
+
+private:
+    // words combined per pass, small enough to stay in L1
+    static constexpr auto chunkWords = size_t{256};
+
+    auto tailMask(size_t j) const noexcept -> uint64_t { return details::blockMask(rows - j * details::blockRows); }
+
+    // Calls fn(firstWord, words, count) with the AND of all slices of all and the ANDNOT of all slices of none.
+    // Only the mentioned slices are read, chunk by chunk.
+    template<class Fn>
+    void scan(F all, F none, Fn &&fn) const noexcept {
+        const auto include = details::flagIndices(all);
+        const auto exclude = details::flagIndices(none);
+        uint64_t chunk[chunkWords];
+        for (auto first = size_t{}; first < bitmapWords(); first += chunkWords) {
+            const auto n = std::min(chunkWords, bitmapWords() - first);
+            for (auto j = size_t{}; j < n; j++) chunk[j] = tailMask(first + j);
+            for (auto b : include) {
+                const auto s = slices[b].data() + first;
+                for (auto j = size_t{}; j < n; j++) chunk[j] &= s[j];
+            }
+            for (auto b : exclude) {
+                const auto s = slices[b].data() + first;
+                for (auto j = size_t{}; j < n; j++) chunk[j] &= ~s[j];
+            }
+            fn(first, chunk, n);
+        }
+    }
+
+private:
+    std::array<std::vector<uint64_t>, flagCount> slices{};
+    size_t rows{};
+};
+
+} // namespace columnar
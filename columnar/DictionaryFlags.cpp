@@ -0,0 +1,7 @@
+#include "DictionaryFlags.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
@@ -0,0 +1,244 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace columnar {
+
+// Dictionary encoded flags column for few distinct combinations
+//
+// Every distinct value is stored once in dictionary(), rows only hold its code:
+// * Byte  - up to 256 distinct values, one byte per row
+// * Short - up to 65536 distinct values, two bytes per row
+// * Plain - a FlagsVector, used once the dictionary would exceed the limit
+// Predicates are evaluated once per dictionary entry, the resulting code table is applied to the rows.
+// Byte codes use AVX2 byte shuffles for the lookup.
+template<class F>
+struct DictionaryFlags {
+    using This = DictionaryFlags;
+    using Flags = F;
+    using Vector = FlagsVector<F>;
+    static constexpr auto npos = Vector::npos;
+    static constexpr auto maxCodes = size_t{65536};
+
+    enum class Encoding { Byte, Short, Plain };
+
+    DictionaryFlags() = default;
+    // switches to plain storage once more than limit distinct values appear
+    explicit DictionaryFlags(size_t limit)
+        : limit(limit < maxCodes ? limit : maxCodes) {}
+
+    auto encoding() const noexcept -> Encoding { return current; }
+    auto size() const noexcept -> size_t { return current == Encoding::Plain ? plain.size() : rows; }
+    bool empty() const noexcept { return size() == 0; }
+    // distinct values in code order, empty for plain storage
+    auto dictionary() const noexcept -> const std::vector<F> & { return values; }
+    // bytes used by codes, dictionary and its hash index or the plain column
+    // The index is estimated as one pointer per bucket plus a node of value, next pointer and hash per entry.
+    auto bytes() const noexcept -> size_t {
+        using Node = typename decltype(codes)::value_type;
+        const auto index = codes.bucket_count() * sizeof(void *) + codes.size() * (sizeof(Node) + 2 * sizeof(void *));
+        return byteCodes.capacity() + shortCodes.capacity() * sizeof(uint16_t) + values.capacity() * sizeof(F) + index
+            + (current == Encoding::Plain ? plain.bitmapWords() * details::blockRows * sizeof(F) : 0);
+    }
+
+    void reserve(size_t n) {
+        if (current == Encoding::Byte) byteCodes.reserve(paddedRows(n));
+        if (current == Encoding::Short) shortCodes.reserve(paddedRows(n));
+        if (current == Encoding::Plain) plain.reserve(n);
+    }
+
+    void push_back(F f) {
+        if (current == Encoding::Plain) return plain.push_back(f);
+        const auto c = encode(f);
+        if (current == Encoding::Plain) return plain.push_back(f);
+        rows++;
+        if (current == Encoding::Byte) {
+            byteCodes.resize(paddedRows(rows));
+            byteCodes[rows - 1] = static_cast<uint8_t>(c);
+        }
+        else {
+            shortCodes.resize(paddedRows(rows));
+            shortCodes[rows - 1] = static_cast<uint16_t>(c);
+        }
+    }
+
+    void set(size_t i, F f) {
+        if (current != Encoding::Plain) {
+            const auto c = encode(f);
+            if (current == Encoding::Byte) return void(byteCodes[i] = static_cast<uint8_t>(c));
+            if (current == Encoding::Short) return void(shortCodes[i] = static_cast<uint16_t>(c));
+        }
+        plain.set(i, f);
+    }
+
+    auto operator[](size_t i) const noexcept -> F {
+        switch (current) {
+        case Encoding::Byte: return values[byteCodes[i]];
+        case Encoding::Short: return values[shortCodes[i]];
+        case Encoding::Plain: return plain[i];
+        }
+        return F{};
+    }
+
+    auto count_all(F mask) const -> size_t { return count_all_none(mask, F{}); }
+    auto count_any(F mask) const -> size_t { return size() - count_none(mask); }
+    auto count_none(F mask) const -> size_t { return count_all_none(F{}, mask); }
+    auto count_all_none(F all, F none) const -> size_t {
+        if (current == Encoding::Plain) return plain.count_all_none(all, none);
+        auto r = size_t{};
+        scan(all, none, [&](size_t, uint64_t m) {
+            r += details::countSetBits(m);
+            return false;
+        });
+        return r;
+    }
+
+    // Writes one bit per row to out, out needs room for bitmapWords() words
+    void bitmap_all(F mask, uint64_t *out) const { bitmap_all_none(mask, F{}, out); }
+    void bitmap_none(F mask, uint64_t *out) const { bitmap_all_none(F{}, mask, out); }
+    void bitmap_any(F mask, uint64_t *out) const {
+        bitmap_all_none(F{}, mask, out);
+        for (auto b = size_t{}; b < bitmapWords(); b++) out[b] = ~out[b] & details::blockMask(size() - b * 64);
+    }
+    void bitmap_all_none(F all, F none, uint64_t *out) const {
+        if (current == Encoding::Plain) return plain.bitmap_all_none(all, none, out);
+        scan(all, none, [&](size_t b, uint64_t m) {
+            out[b] = m;
+            return false;
+        });
+    }
+
+    auto bitmap_all(F mask) const -> std::vector<uint64_t> { return bitmap_all_none(mask, F{}); }
+    auto bitmap_none(F mask) const -> std::vector<uint64_t> { return bitmap_all_none(F{}, mask); }
+    auto bitmap_any(F mask) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(bitmapWords());
+        bitmap_any(mask, r.data());
+        return r;
+    }
+    auto bitmap_all_none(F all, F none) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(bitmapWords());
+        bitmap_all_none(all, none, r.data());
+        return r;
+    }
+
+    auto bitmapWords() const noexcept -> size_t { return paddedRows(size()) / details::blockRows; }
+
+    // first row at or after from with all of all and none of none, npos if there is none
+    auto find_first_all_none(F all, F none, size_t from = 0) const -> size_t {
+        if (current == Encoding::Plain) return plain.find_first_all_none(all, none, from);
+        auto r = npos;
+        const auto first = from / details::blockRows;
+        scan(
+            all,
+            none,
+            [&](size_t b, uint64_t m) {
+                if (b == first) m &= ~details::blockMask(from % details::blockRows);
+                if (m == 0) return false;
+                r = b * details::blockRows + details::countTrailingZeros(m);
+                return true;
+            },
+            first);
+        return r;
+    }
+    auto find_first_all(F mask, size_t from = 0) const -> size_t { return find_first_all_none(mask, F{}, from); }
+    auto find_first_none(F mask, size_t from = 0) const -> size_t {
+        return find_first_all_none(F{}, mask, from);
+    }
+
+private:
+    using Key = std::array<uint64_t, (sizeof(F) + 7) / 8>;
+    struct KeyHash {
+        auto operator()(const Key &k) const noexcept -> size_t {
+            auto h = uint64_t{0x9e3779b97f4a7c15};
+            for (auto w : k) h = (h ^ w) * 0xff51afd7ed558ccd, h ^= h >> 32;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    static auto toKey(F f) noexcept -> Key {
+        auto k = Key{};
+        std::memcpy(k.data(), &f, sizeof(F));
+        return k;
+    }
+
+    static constexpr auto paddedRows(size_t n) noexcept -> size_t {
+        return (n + details::blockRows - 1) / details::blockRows * details::blockRows;
+    }
+
+    // code of f, grows the dictionary and switches encodings as needed
+    auto encode(F f) -> size_t {
+        const auto [it, inserted] = codes.try_emplace(toKey(f), values.size());
+        if (!inserted) return it->second;
+        if (values.size() == limit) {
+            toPlain();
+            return 0;
+        }
+        values.push_back(f);
+        if (current == Encoding::Byte && values.size() > 256) {
+            shortCodes.assign(byteCodes.begin(), byteCodes.end());
+            byteCodes = {};
+            current = Encoding::Short;
+        }
+        return it->second;
+    }
+
+    void toPlain() {
+        plain.reserve(rows);
+        for (auto i = size_t{}; i < rows; i++) plain.push_back((*this)[i]);
+        byteCodes = {};
+        shortCodes = {};
+        values = {};
+        codes = {};
+        current = Encoding::Plain;
+    }
+
+    // Calls fn(block, rowBits) for every block of 64 rows from first on until fn returns true.
+    template<class Fn>
+    void scan(F all, F none, Fn &&fn, size_t first = 0) const {
+        const auto include = toKey(all);
+        const auto exclude = toKey(none);
+        auto matches = [&](F f) {
+            const auto k = toKey(f);
+            for (auto i = size_t{}; i < k.size(); i++)
+                if ((k[i] & include[i]) != include[i] || (k[i] & exclude[i]) != 0) return false;
+            return true;
+        };
+
+        if (current == Encoding::Byte) {
+            auto table = details::ByteLookup{};
+            for (auto c = size_t{}; c < values.size(); c++)
+                if (matches(values[c])) table.add(static_cast<uint8_t>(c));
+            for (auto b = first; b < bitmapWords(); b++) {
+                const auto m = details::lookupBlock(byteCodes.data(), table, b * details::blockRows);
+                if (fn(b, m & details::blockMask(rows - b * details::blockRows))) return;
+            }
+        }
+        else {
+            auto table = std::vector<uint64_t>(maxCodes / 64);
+            for (auto c = size_t{}; c < values.size(); c++)
+                if (matches(values[c])) table[c / 64] |= uint64_t{1} << (c % 64);
+            for (auto b = first; b < bitmapWords(); b++) {
+                const auto m = details::lookupBlock(shortCodes.data(), table.data(), b * details::blockRows);
+                if (fn(b, m & details::blockMask(rows - b * details::blockRows))) return;
+            }
+        }
+    }
+
+private:
+    Encoding current = Encoding::Byte;
+    size_t limit = maxCodes;
+    size_t rows{};
+    std::vector<uint8_t> byteCodes{};
+    std::vector<uint16_t> shortCodes{};
+    std::vector<F> values{};
+    std::unordered_map<Key, size_t, KeyHash> codes{};
+    Vector plain{};
+};
+
+} // namespace columnar
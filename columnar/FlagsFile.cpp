@@ -0,0 +1,334 @@
+#include "FlagsFile.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define COLUMNAR_HAS_FLAGS_FILE 1
+#endif
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace columnar::details {
+
+namespace {
+
+// First bytes of every flags file, the names follow directly
+struct FileHeader {
+    static constexpr auto magicValue = uint64_t{0x314c4f4353474c46}; // "FLGSCOL1"
+    static constexpr auto versionValue = uint32_t{1};
+    static constexpr auto byteOrderValue = uint32_t{0x01020304};
+    static constexpr auto alignment = uint64_t{4096};
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t wordSize;
+    uint32_t planeCount;
+    uint32_t bitCount;
+    uint32_t pageRows;
+    uint64_t capacity;
+    uint64_t headerSize;
+    uint64_t dataOffset;
+    uint64_t planeStride;
+    uint64_t checksumOffset;
+    uint64_t fileSize;
+    uint32_t nameCount;
+    uint32_t nameBytes;
+    // covers everything before it and the names
+    uint32_t headerChecksum;
+    uint32_t reserved;
+    // written last on every commit, not part of the checksum
+    uint64_t rows;
+
+    auto pageBytes() const noexcept -> uint64_t { return uint64_t{pageRows} * wordSize; }
+    auto pageCount() const noexcept -> uint64_t { return capacity / pageRows; }
+    auto pageOffset(uint64_t page, size_t k) const noexcept -> uint64_t {
+        return dataOffset + k * planeStride + page * pageBytes();
+    }
+    auto checksumAt(uint64_t page, size_t k) const noexcept -> uint64_t {
+        return checksumOffset + (page * planeCount + k) * sizeof(uint32_t);
+    }
+
+    auto checksum(const unsigned char *names) const noexcept -> uint32_t {
+        return crc32c(names, nameBytes, crc32c(this, offsetof(FileHeader, headerChecksum)));
+    }
+
+    bool matches(FileLayout layout) const noexcept {
+        return magic == magicValue && version == versionValue && byteOrder == byteOrderValue
+            && wordSize == layout.wordSize && planeCount == layout.planeCount && bitCount == layout.bitCount;
+    }
+    // offsets are consistent and inside a file of size bytes
+    bool fits(uint64_t size) const noexcept {
+        return pageRows != 0 && capacity % pageRows == 0 && headerSize >= sizeof(FileHeader) + nameBytes
+            && dataOffset >= headerSize && planeStride >= capacity * wordSize
+            && checksumOffset >= dataOffset + planeCount * planeStride
+            && fileSize >= checksumOffset + pageCount() * planeCount * sizeof(uint32_t) && fileSize <= size
+            && rows <= capacity;
+    }
+};
+
+constexpr auto alignUp(uint64_t v, uint64_t a) noexcept -> uint64_t { return (v + a - 1) / a * a; }
+
+auto crcTable() noexcept -> const std::array<uint32_t, 256> & {
+    static const auto table = [] {
+        auto t = std::array<uint32_t, 256>{};
+        for (auto i = uint32_t{}; i < 256; i++) {
+            auto c = i;
+            for (auto b = 0; b < 8; b++) c = (c >> 1) ^ (c & 1 ? 0x82f63b78 : 0);
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+auto namesOf(const unsigned char *names, uint32_t count) -> std::vector<std::string> {
+    auto r = std::vector<std::string>{};
+    auto p = reinterpret_cast<const char *>(names);
+    for (auto i = uint32_t{}; i < count; i++) {
+        r.emplace_back(p);
+        p += r.back().size() + 1;
+    }
+    return r;
+}
+
+} // namespace
+
+auto crc32c(const void *data, size_t bytes, uint32_t crc) noexcept -> uint32_t {
+    auto p = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        auto w = uint64_t{};
+        std::memcpy(&w, p, sizeof(w));
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, w));
+    }
+#endif
+    const auto &table = crcTable();
+    for (; bytes > 0; bytes--, p++) crc = (crc >> 8) ^ table[(crc ^ *p) & 0xff];
+    return ~crc;
+}
+
+#ifdef COLUMNAR_HAS_FLAGS_FILE
+
+namespace {
+
+bool readAll(int fd, void *out, size_t bytes, uint64_t offset) noexcept {
+    auto p = static_cast<unsigned char *>(out);
+    while (bytes > 0) {
+        const auto n = pread(fd, p, bytes, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        p += n, bytes -= static_cast<size_t>(n), offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool writeAll(int fd, const void *data, size_t bytes, uint64_t offset) noexcept {
+    auto p = static_cast<const unsigned char *>(data);
+    while (bytes > 0) {
+        const auto n = pwrite(fd, p, bytes, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        p += n, bytes -= static_cast<size_t>(n), offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool syncData(int fd) noexcept {
+#if defined(__APPLE__)
+    return fsync(fd) == 0;
+#else
+    return fdatasync(fd) == 0;
+#endif
+}
+
+auto headerOf(const unsigned char *base) noexcept -> const FileHeader * {
+    return reinterpret_cast<const FileHeader *>(base);
+}
+
+} // namespace
+
+auto MappedColumn::open(std::string_view path, FileLayout layout, const std::vector<std::string> &names) noexcept
+    -> std::optional<MappedColumn> {
+    const auto fd = ::open(std::string{path}.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct stat st {};
+    const auto size = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : size_t{};
+    auto map = size >= sizeof(FileHeader) ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) return std::nullopt;
+
+    auto r = MappedColumn{static_cast<const unsigned char *>(map), size};
+    const auto header = headerOf(r.base);
+    if (!header->matches(layout) || !header->fits(size)) return std::nullopt;
+    if (header->checksum(r.base + sizeof(FileHeader)) != header->headerChecksum) return std::nullopt;
+    if (!names.empty() && header->nameCount != 0 && r.names() != names) return std::nullopt;
+    return r;
+}
+
+MappedColumn::~MappedColumn() {
+    if (base != nullptr) munmap(const_cast<unsigned char *>(base), size);
+}
+
+auto MappedColumn::rows() const noexcept -> uint64_t {
+    return reinterpret_cast<const volatile FileHeader *>(base)->rows;
+}
+
+auto MappedColumn::plane(size_t k) const noexcept -> const void * {
+    const auto header = headerOf(base);
+    return base + header->dataOffset + k * header->planeStride;
+}
+
+auto MappedColumn::names() const -> std::vector<std::string> {
+    return namesOf(base + sizeof(FileHeader), headerOf(base)->nameCount);
+}
+
+auto MappedColumn::verify() const noexcept -> size_t {
+    const auto header = headerOf(base);
+    const auto pages = (rows() + header->pageRows - 1) / header->pageRows;
+    for (auto page = uint64_t{}; page < pages; page++) {
+        for (auto k = size_t{}; k < header->planeCount; k++) {
+            auto stored = uint32_t{};
+            std::memcpy(&stored, base + header->checksumAt(page, k), sizeof(stored));
+            if (crc32c(base + header->pageOffset(page, k), header->pageBytes()) != stored)
+                return static_cast<size_t>(page);
+        }
+    }
+    return npos;
+}
+
+auto ColumnAppender::create(std::string_view path, FileLayout layout, uint64_t capacity, uint32_t pageRows,
+                            const std::vector<std::string> &names) noexcept -> std::optional<ColumnAppender> {
+    auto nameBytes = size_t{};
+    for (const auto &n : names) {
+        if (n.find('\0') != std::string::npos) return std::nullopt;
+        nameBytes += n.size() + 1;
+    }
+
+    auto header = FileHeader{};
+    header.magic = FileHeader::magicValue;
+    header.version = FileHeader::versionValue;
+    header.byteOrder = FileHeader::byteOrderValue;
+    header.wordSize = layout.wordSize;
+    header.planeCount = layout.planeCount;
+    header.bitCount = layout.bitCount;
+    header.pageRows = static_cast<uint32_t>(alignUp(pageRows == 0 ? 1 : pageRows, blockRows));
+    header.capacity = alignUp(capacity == 0 ? 1 : capacity, header.pageRows);
+    header.headerSize = alignUp(sizeof(FileHeader) + nameBytes, FileHeader::alignment);
+    header.dataOffset = header.headerSize;
+    header.planeStride = alignUp(header.capacity * header.wordSize, FileHeader::alignment);
+    header.checksumOffset = header.dataOffset + header.planeCount * header.planeStride;
+    header.fileSize = header.checksumOffset + header.pageCount() * header.planeCount * sizeof(uint32_t);
+    header.nameCount = static_cast<uint32_t>(names.size());
+    header.nameBytes = static_cast<uint32_t>(nameBytes);
+
+    auto block = std::vector<unsigned char>(sizeof(FileHeader) + nameBytes);
+    auto at = sizeof(FileHeader);
+    for (const auto &n : names) {
+        std::memcpy(block.data() + at, n.c_str(), n.size() + 1);
+        at += n.size() + 1;
+    }
+    header.headerChecksum = header.checksum(block.data() + sizeof(FileHeader));
+    std::memcpy(block.data(), &header, sizeof(FileHeader));
+
+    const auto fd = ::open(std::string{path}.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return std::nullopt;
+    // the file stays sparse, pages are only allocated when they are written
+    auto r = ColumnAppender{};
+    r.fd = fd;
+    if (ftruncate(fd, static_cast<off_t>(header.fileSize)) != 0 || !writeAll(fd, block.data(), block.size(), 0)
+        || !syncData(fd))
+        return std::nullopt;
+    r.layout = layout;
+    r.capacity = header.capacity;
+    r.pageRows = header.pageRows;
+    r.dataOffset = header.dataOffset;
+    r.planeStride = header.planeStride;
+    r.checksumOffset = header.checksumOffset;
+    return r;
+}
+
+auto ColumnAppender::open(std::string_view path, FileLayout layout) noexcept -> std::optional<ColumnAppender> {
+    const auto fd = ::open(std::string{path}.c_str(), O_RDWR);
+    if (fd < 0) return std::nullopt;
+    auto r = ColumnAppender{};
+    r.fd = fd;
+
+    struct stat st {};
+    auto header = FileHeader{};
+    if (fstat(fd, &st) != 0 || !readAll(fd, &header, sizeof(header), 0)) return std::nullopt;
+    if (!header.matches(layout) || !header.fits(static_cast<uint64_t>(st.st_size))) return std::nullopt;
+    auto names = std::vector<unsigned char>(header.nameBytes);
+    if (!readAll(fd, names.data(), names.size(), sizeof(FileHeader))) return std::nullopt;
+    if (header.checksum(names.data()) != header.headerChecksum) return std::nullopt;
+
+    r.layout = layout;
+    r.capacity = header.capacity;
+    r.pageRows = header.pageRows;
+    r.rows = header.rows;
+    r.dataOffset = header.dataOffset;
+    r.planeStride = header.planeStride;
+    r.checksumOffset = header.checksumOffset;
+    return r;
+}
+
+ColumnAppender::~ColumnAppender() {
+    if (fd >= 0) close(fd);
+}
+
+bool ColumnAppender::readPage(uint64_t page, size_t k, void *out) const noexcept {
+    const auto bytes = uint64_t{pageRows} * layout.wordSize;
+    return readAll(fd, out, bytes, dataOffset + k * planeStride + page * bytes);
+}
+
+bool ColumnAppender::writePage(uint64_t page, size_t k, const void *data) noexcept {
+    if (fd < 0 || page >= capacity / pageRows) return false;
+    const auto bytes = uint64_t{pageRows} * layout.wordSize;
+    const auto checksum = crc32c(data, bytes);
+    return writeAll(fd, data, bytes, dataOffset + k * planeStride + page * bytes)
+        && writeAll(fd, &checksum, sizeof(checksum), checksumOffset + (page * layout.planeCount + k) * sizeof(checksum));
+}
+
+bool ColumnAppender::commit(uint64_t committed) noexcept {
+    if (fd < 0 || committed > capacity) return false;
+    if (committed == rows) return true;
+    // pages and checksums reach the disk before the row count that makes them visible
+    if (!syncData(fd) || !writeAll(fd, &committed, sizeof(committed), offsetof(FileHeader, rows)) || !syncData(fd))
+        return false;
+    rows = committed;
+    return true;
+}
+
+#else
+
+auto MappedColumn::open(std::string_view, FileLayout, const std::vector<std::string> &) noexcept
+    -> std::optional<MappedColumn> {
+    return std::nullopt;
+}
+MappedColumn::~MappedColumn() = default;
+auto MappedColumn::rows() const noexcept -> uint64_t { return 0; }
+auto MappedColumn::plane(size_t) const noexcept -> const void * { return nullptr; }
+auto MappedColumn::names() const -> std::vector<std::string> { return {}; }
+auto MappedColumn::verify() const noexcept -> size_t { return npos; }
+
+auto ColumnAppender::create(std::string_view, FileLayout, uint64_t, uint32_t, const std::vector<std::string> &) noexcept
+    -> std::optional<ColumnAppender> {
+    return std::nullopt;
+}
+auto ColumnAppender::open(std::string_view, FileLayout) noexcept -> std::optional<ColumnAppender> {
+    return std::nullopt;
+}
+ColumnAppender::~ColumnAppender() = default;
+bool ColumnAppender::readPage(uint64_t, size_t, void *) const noexcept { return false; }
+bool ColumnAppender::writePage(uint64_t, size_t, const void *) noexcept { return false; }
+bool ColumnAppender::commit(uint64_t) noexcept { return false; }
+
+#endif
+
+} // namespace columnar::details
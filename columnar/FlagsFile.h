@@ -0,0 +1,280 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace columnar {
+
+namespace details {
+
+// Layout of a flags type as recorded in a flags file
+struct FileLayout {
+    uint32_t wordSize{};
+    uint32_t planeCount{};
+    uint32_t bitCount{};
+
+    template<class F>
+    static auto of() noexcept -> FileLayout {
+        using View = FlagsView<F>;
+        return {sizeof(typename View::Word), uint32_t{View::planeCount}, uint32_t{View::flagCount}};
+    }
+};
+
+// CRC-32C (Castagnoli), uses the SSE 4.2 instruction when it is enabled
+auto crc32c(const void *data, size_t bytes, uint32_t crc = 0) noexcept -> uint32_t;
+
+// Read-only mapping of a flags file
+struct MappedColumn {
+    using This = MappedColumn;
+    static constexpr auto npos = ~size_t{};
+
+    static auto open(std::string_view path, FileLayout layout, const std::vector<std::string> &names) noexcept
+        -> std::optional<MappedColumn>;
+
+    MappedColumn(This &&o) noexcept
+        : base(std::exchange(o.base, nullptr))
+        , size(std::exchange(o.size, 0)) {}
+    auto operator=(This &&o) noexcept -> This & {
+        std::swap(base, o.base);
+        std::swap(size, o.size);
+        return *this;
+    }
+    ~MappedColumn();
+
+    // committed rows, a writer may raise them while the file is mapped
+    auto rows() const noexcept -> uint64_t;
+    auto plane(size_t k) const noexcept -> const void *;
+    auto names() const -> std::vector<std::string>;
+    auto verify() const noexcept -> size_t;
+
+private:
+    MappedColumn(const unsigned char *base, size_t size) noexcept
+        : base(base)
+        , size(size) {}
+
+private:
+    const unsigned char *base{};
+    size_t size{};
+};
+
+// Write side of a flags file, writes whole pages of one plane and commits row counts
+struct ColumnAppender {
+    using This = ColumnAppender;
+
+    static auto create(std::string_view path, FileLayout layout, uint64_t capacity, uint32_t pageRows,
+                       const std::vector<std::string> &names) noexcept -> std::optional<ColumnAppender>;
+    static auto open(std::string_view path, FileLayout layout) noexcept -> std::optional<ColumnAppender>;
+
+    ColumnAppender(This &&o) noexcept
+        : fd(std::exchange(o.fd, -1))
+        , layout(o.layout)
+        , capacity(o.capacity)
+        , pageRows(o.pageRows)
+        , rows(o.rows)
+        , dataOffset(o.dataOffset)
+        , planeStride(o.planeStride)
+        , checksumOffset(o.checksumOffset) {}
+    auto operator=(This &&o) noexcept -> This & {
+        std::swap(fd, o.fd);
+        layout = o.layout;
+        capacity = o.capacity;
+        pageRows = o.pageRows;
+        rows = o.rows;
+        dataOffset = o.dataOffset;
+        planeStride = o.planeStride;
+        checksumOffset = o.checksumOffset;
+        return *this;
+    }
+    ~ColumnAppender();
+
+    auto committedRows() const noexcept -> uint64_t { return rows; }
+    auto rowCapacity() const noexcept -> uint64_t { return capacity; }
+    auto rowsPerPage() const noexcept -> uint32_t { return pageRows; }
+
+    // page bytes of plane k, pageRows words
+    bool readPage(uint64_t page, size_t k, void *out) const noexcept;
+    bool writePage(uint64_t page, size_t k, const void *data) noexcept;
+    // makes rows visible to readers once the pages are on disk
+    bool commit(uint64_t rows) noexcept;
+
+private:
+    ColumnAppender() = default;
+
+private:
+    int fd = -1;
+    FileLayout layout{};
+    uint64_t capacity{};
+    uint32_t pageRows{};
+    uint64_t rows{};
+    uint64_t dataOffset{};
+    uint64_t planeStride{};
+    uint64_t checksumOffset{};
+};
+
+} // namespace details
+
+// Read-only flags column mapped from a file, queries run directly on the mapped pages
+//
+// File format (version 1, native byte order, checked on open):
+// * header page: magic, version, byte order, word size, plane count, bitCount, page rows, capacity,
+//   committed rows, the flag names and a CRC-32C of the header
+// * one region per plane with room for capacity rows, each aligned to 4 KiB (unwritten parts stay sparse)
+// * a CRC-32C per page of pageRows rows of every plane
+//
+//     auto file = columnar::FlagsFile<Animals>::open("animals.flags");
+//     auto cats = file->view().count_all(Animal::Cat);
+template<class F>
+struct FlagsFile {
+    using This = FlagsFile;
+    using View = FlagsView<F>;
+    static constexpr auto npos = details::MappedColumn::npos;
+
+    // nullopt if the file is missing or has another layout
+    // Non empty names have to match the names stored in the file.
+    static auto open(std::string_view path, const std::vector<std::string> &names = {}) noexcept
+        -> std::optional<FlagsFile> {
+        auto column = details::MappedColumn::open(path, details::FileLayout::of<F>(), names);
+        if (!column) return std::nullopt;
+        return FlagsFile{std::move(*column)};
+    }
+
+    // rows committed when the file was opened
+    auto size() const noexcept -> size_t { return rows; }
+    auto names() const -> std::vector<std::string> { return column.names(); }
+
+    // zero-copy view, valid as long as the file object lives
+    auto view() const noexcept -> View {
+        auto planes = typename View::Planes{};
+        for (auto k = size_t{}; k < View::planeCount; k++)
+            planes[k] = static_cast<const typename View::Word *>(column.plane(k));
+        return {planes, size()};
+    }
+
+    // Reads every committed page and returns the first one with a wrong checksum, npos if all match
+    auto verify() const noexcept -> size_t { return column.verify(); }
+
+private:
+    explicit FlagsFile(details::MappedColumn &&column) noexcept
+        : column(std::move(column))
+        , rows(static_cast<size_t>(this->column.rows())) {}
+
+private:
+    details::MappedColumn column;
+    size_t rows{};
+};
+
+// Append-only writer of a flags file
+// Rows are buffered per page, flush() writes the pages with their checksums and then commits the row count.
+// Readers that open the file afterwards see all committed rows.
+template<class F>
+struct FlagsFileWriter {
+    using This = FlagsFileWriter;
+    using Word = typename FlagsView<F>::Word;
+    static constexpr auto planeCount = FlagsView<F>::planeCount;
+    static constexpr auto defaultPageRows = uint32_t{65536};
+
+    // Creates the file with room for capacity rows, pageRows is rounded up to a multiple of 64
+    static auto create(std::string_view path, size_t capacity, const std::vector<std::string> &names = {},
+                       uint32_t pageRows = defaultPageRows) -> std::optional<FlagsFileWriter> {
+        auto file = details::ColumnAppender::create(path, details::FileLayout::of<F>(), capacity, pageRows, names);
+        if (!file) return std::nullopt;
+        return FlagsFileWriter{std::move(*file)};
+    }
+
+    // Continues an existing file after its committed rows
+    static auto append(std::string_view path) -> std::optional<FlagsFileWriter> {
+        auto file = details::ColumnAppender::open(path, details::FileLayout::of<F>());
+        if (!file) return std::nullopt;
+        auto r = FlagsFileWriter{std::move(*file)};
+        if (r.pending != 0 && !r.loadPage()) return std::nullopt;
+        return r;
+    }
+
+    // a moved from writer holds no rows and rejects all further calls
+    FlagsFileWriter(This &&o) noexcept
+        : file(std::move(o.file))
+        , buffer(std::move(o.buffer))
+        , page(o.page)
+        , pending(std::exchange(o.pending, 0))
+        , failed(std::exchange(o.failed, true)) {}
+    // flushes the rows of this writer before taking over the other file
+    auto operator=(This &&o) noexcept -> This & {
+        if (this == &o) return *this;
+        flush();
+        file = std::move(o.file);
+        buffer = std::move(o.buffer);
+        page = o.page;
+        pending = std::exchange(o.pending, 0);
+        failed = std::exchange(o.failed, true);
+        return *this;
+    }
+    ~FlagsFileWriter() { flush(); }
+
+    auto size() const noexcept -> size_t { return static_cast<size_t>(page * file.rowsPerPage() + pending); }
+    auto capacity() const noexcept -> size_t { return static_cast<size_t>(file.rowCapacity()); }
+
+    // false once the file is full or a page could not be written, the writer rejects all rows after a failed write
+    bool push_back(F f) {
+        if (failed || size() == capacity()) return false;
+        auto w = std::array<Word, planeCount>{};
+        std::memcpy(w.data(), &f, sizeof(F));
+        for (auto k = size_t{}; k < planeCount; k++) buffer[k][pending] = w[k];
+        if (++pending == file.rowsPerPage()) {
+            if (!writePage()) {
+                failed = true;
+                return false;
+            }
+            page++;
+            pending = 0;
+            for (auto &b : buffer) std::fill(b.begin(), b.end(), Word{});
+        }
+        return true;
+    }
+
+    // writes the partial page and commits all rows
+    bool flush() noexcept {
+        if (failed) return false;
+        if (pending != 0 && !writePage()) {
+            failed = true;
+            return false;
+        }
+        return file.commit(size());
+    }
+
+private:
+    explicit FlagsFileWriter(details::ColumnAppender &&file)
+        : file(std::move(file))
+        , page(this->file.committedRows() / this->file.rowsPerPage())
+        , pending(static_cast<uint32_t>(this->file.committedRows() % this->file.rowsPerPage())) {
+        for (auto &b : buffer) b.resize(this->file.rowsPerPage());
+    }
+
+    bool writePage() noexcept {
+        for (auto k = size_t{}; k < planeCount; k++)
+            if (!file.writePage(page, k, buffer[k].data())) return false;
+        return true;
+    }
+    bool loadPage() noexcept {
+        for (auto k = size_t{}; k < planeCount; k++)
+            if (!file.readPage(page, k, buffer[k].data())) return false;
+        return true;
+    }
+
+private:
+    details::ColumnAppender file;
+    std::array<std::vector<Word>, planeCount> buffer{};
+    uint64_t page{};
+    uint32_t pending{};
+    bool failed{}; // rows of the current page may be lost, nothing is committed any more
+};
+
+} // namespace columnar
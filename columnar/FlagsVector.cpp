@@ -0,0 +1,7 @@
+#include "FlagsVector.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
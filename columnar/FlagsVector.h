@@ -0,0 +1,326 @@
+#pragma once
+#include "details/PositionalCount.h"
+#include "details/ScanKernels.h"
+
+#include "meta/details/BitStorage.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+namespace columnar {
+
+namespace details {
+
+template<size_t bytes>
+constexpr auto selectPlaneWord() {
+    if constexpr (bytes <= sizeof(uint64_t))
+        return meta::details::SelectBitWord<bytes * 8>();
+    else
+        return uint64_t{};
+}
+
+// number of usable bits, flags without a bitCount use every bit of their storage
+template<class F, class = void>
+struct FlagCount : std::integral_constant<size_t, sizeof(F) * 8> {};
+
+template<class F>
+struct FlagCount<F, std::void_t<decltype(F::bitCount)>> : std::integral_constant<size_t, F::bitCount> {};
+
+// indices of the set flags, in ascending order
+template<class F>
+struct FlagIndices {
+    std::array<size_t, FlagCount<F>::value> at{};
+    size_t count{};
+
+    auto begin() const noexcept { return at.begin(); }
+    auto end() const noexcept { return at.begin() + count; }
+};
+
+template<class F>
+auto flagIndices(F f) noexcept -> FlagIndices<F> {
+    // copied into the storage words, so bit b of word k is flag k * wordBits + b on every byte order
+    using Word = decltype(selectPlaneWord<sizeof(F)>());
+    constexpr auto wordBits = sizeof(Word) * 8;
+    auto w = std::array<Word, sizeof(F) / sizeof(Word)>{};
+    std::memcpy(w.data(), &f, sizeof(F));
+    auto r = FlagIndices<F>{};
+    for (auto k = size_t{}; k < w.size(); k++) {
+        for (auto v = uint64_t{w[k]}; v != 0; v &= v - 1) {
+            const auto b = k * wordBits + countTrailingZeros(v);
+            if (b < FlagCount<F>::value) r.at[r.count++] = b;
+        }
+    }
+    return r;
+}
+
+// Adds vertical popcounts of words with wordBits bits to histogram, bit p is flag index firstFlag + p % wordBits
+template<size_t Flags>
+void addPositions(const PositionalCount::Counts &positions, size_t wordBits, size_t firstFlag,
+                  std::array<uint64_t, Flags> &histogram) noexcept {
+    for (auto p = size_t{}; p < positions.size(); p++) {
+        const auto b = firstFlag + p % wordBits;
+        if (b < Flags) histogram[b] += positions[p];
+    }
+}
+
+// Counts the rows [first, last) of a plane, first has to start a block
+// The rows of the last partial block are copied, so the padding rows may hold anything.
+template<class Word>
+void countPlaneRows(PositionalCount &counter, const Word *plane, size_t first, size_t last) noexcept {
+    const auto full = first + (last - first) / blockRows * blockRows;
+    counter.add(plane + first, (full - first) * sizeof(Word) / sizeof(uint64_t));
+    if (full == last) return;
+    Word tail[blockRows] = {};
+    std::memcpy(tail, plane + full, (last - full) * sizeof(Word));
+    counter.add(tail, blockRows * sizeof(Word) / sizeof(uint64_t));
+}
+
+} // namespace details
+
+// number of values with flag index b (indexOf) at [b]
+template<class F>
+using FlagHistogram = std::array<uint64_t, details::FlagCount<F>::value>;
+
+namespace details {
+
+// Read-only bulk queries shared by FlagsVector and FlagsView
+// Derived provides size() and plane(k), every plane readable up to a multiple of 64 rows.
+template<class Derived, class F>
+struct FlagsQueries {
+    using Flags = F;
+    using Word = decltype(selectPlaneWord<sizeof(F)>());
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+    static_assert(sizeof(F) % sizeof(Word) == 0, "flags have to be a whole number of words");
+
+    static constexpr auto planeCount = sizeof(F) / sizeof(Word);
+    static constexpr auto wordBits = sizeof(Word) * 8;
+    static constexpr auto flagCount = FlagCount<F>::value;
+    static constexpr auto npos = ~size_t{};
+
+    auto operator[](size_t i) const noexcept -> F {
+        auto w = std::array<Word, planeCount>{};
+        for (auto k = size_t{}; k < planeCount; k++) w[k] = self().plane(k)[i];
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), w.data(), sizeof(F));
+        return r;
+    }
+
+    // number of rows with all bits of mask
+    auto count_all(F mask) const noexcept -> size_t { return count({toWords(mask), {}}); }
+    // number of rows with any bit of mask
+    auto count_any(F mask) const noexcept -> size_t { return self().size() - count_none(mask); }
+    // number of rows without any bit of mask
+    auto count_none(F mask) const noexcept -> size_t { return count({{}, toWords(mask)}); }
+    // number of rows with all bits of all and none of none
+    auto count_all_none(F all, F none) const noexcept -> size_t { return count({toWords(all), toWords(none)}); }
+
+    // Writes one bit per row (row i is bit i % 64 of word i / 64) to out.
+    // out needs room for bitmapWords() words, bits past size() are cleared.
+    void bitmap_all(F mask, uint64_t *out) const noexcept { bitmap({toWords(mask), {}}, false, out); }
+    void bitmap_any(F mask, uint64_t *out) const noexcept { bitmap({{}, toWords(mask)}, true, out); }
+    void bitmap_none(F mask, uint64_t *out) const noexcept { bitmap({{}, toWords(mask)}, false, out); }
+    void bitmap_all_none(F all, F none, uint64_t *out) const noexcept {
+        bitmap({toWords(all), toWords(none)}, false, out);
+    }
+
+    auto bitmap_all(F mask) const -> std::vector<uint64_t> { return bitmap({toWords(mask), {}}, false); }
+    auto bitmap_any(F mask) const -> std::vector<uint64_t> { return bitmap({{}, toWords(mask)}, true); }
+    auto bitmap_none(F mask) const -> std::vector<uint64_t> { return bitmap({{}, toWords(mask)}, false); }
+    auto bitmap_all_none(F all, F none) const -> std::vector<uint64_t> {
+        return bitmap({toWords(all), toWords(none)}, false);
+    }
+
+    auto bitmapWords() const noexcept -> size_t { return paddedRows(self().size()) / blockRows; }
+
+    // number of rows for every flag, counted with a vertical popcount over the planes
+    auto histogram() const noexcept -> FlagHistogram<F> {
+        auto r = FlagHistogram<F>{};
+        for (auto k = size_t{}; k < planeCount; k++) {
+            auto counter = PositionalCount{};
+            countPlaneRows(counter, self().plane(k), 0, self().size());
+            addPositions(counter.result(), wordBits, k * wordBits, r);
+        }
+        return r;
+    }
+
+    // first matching row at or after from, npos if there is none
+    auto find_first_all(F mask, size_t from = 0) const noexcept -> size_t {
+        return find({toWords(mask), {}}, false, from);
+    }
+    auto find_first_any(F mask, size_t from = 0) const noexcept -> size_t {
+        return find({{}, toWords(mask)}, true, from);
+    }
+    auto find_first_none(F mask, size_t from = 0) const noexcept -> size_t {
+        return find({{}, toWords(mask)}, false, from);
+    }
+    auto find_first_all_none(F all, F none, size_t from = 0) const noexcept -> size_t {
+        return find({toWords(all), toWords(none)}, false, from);
+    }
+
+protected:
+    using Predicate = details::Predicate<Word, planeCount>;
+
+    static constexpr auto paddedRows(size_t n) noexcept -> size_t {
+        return (n + blockRows - 1) / blockRows * blockRows;
+    }
+
+    static auto toWords(F f) noexcept -> std::array<Word, planeCount> {
+        auto r = std::array<Word, planeCount>{};
+        std::memcpy(r.data(), &f, sizeof(F));
+        return r;
+    }
+
+private:
+    auto self() const noexcept -> const Derived & { return static_cast<const Derived &>(*this); }
+
+    auto columns() const noexcept -> Columns<Word, planeCount> {
+        auto r = Columns<Word, planeCount>{};
+        for (auto k = size_t{}; k < planeCount; k++) r[k] = self().plane(k);
+        return r;
+    }
+
+    // matches of block b, inverted for any queries, restricted to existing rows
+    auto block(const Columns<Word, planeCount> &c, const Predicate &p, bool invert, size_t b) const noexcept
+        -> uint64_t {
+        const auto row = b * blockRows;
+        const auto m = matchBlock(c, p, row);
+        return (invert ? ~m : m) & blockMask(self().size() - row);
+    }
+
+    auto count(const Predicate &p) const noexcept -> size_t {
+        const auto c = columns();
+        auto r = size_t{};
+        for (auto b = size_t{}; b < bitmapWords(); b++) r += countSetBits(block(c, p, false, b));
+        return r;
+    }
+
+    void bitmap(const Predicate &p, bool invert, uint64_t *out) const noexcept {
+        const auto c = columns();
+        for (auto b = size_t{}; b < bitmapWords(); b++) out[b] = block(c, p, invert, b);
+    }
+    auto bitmap(const Predicate &p, bool invert) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(bitmapWords());
+        bitmap(p, invert, r.data());
+        return r;
+    }
+
+    auto find(const Predicate &p, bool invert, size_t from) const noexcept -> size_t {
+        if (from >= self().size()) return npos;
+        const auto c = columns();
+        auto b = from / blockRows;
+        auto m = block(c, p, invert, b) & ~blockMask(from % blockRows);
+        while (m == 0) {
+            if (++b == bitmapWords()) return npos;
+            m = block(c, p, invert, b);
+        }
+        return b * blockRows + countTrailingZeros(m);
+    }
+};
+
+} // namespace details
+
+// Read-only column of flags over planes owned by someone else (a FlagsVector or a mapped file)
+// Offers all bulk queries of FlagsVector.
+template<class F>
+struct FlagsView : details::FlagsQueries<FlagsView<F>, F> {
+    using This = FlagsView;
+    using Base = details::FlagsQueries<FlagsView<F>, F>;
+    using Word = typename Base::Word;
+    static constexpr auto planeCount = Base::planeCount;
+    using Planes = details::Columns<Word, planeCount>;
+
+    FlagsView() = default;
+    // every plane has to be readable for rows rounded up to a multiple of 64
+    FlagsView(Planes planes, size_t rows) noexcept
+        : planes(planes)
+        , rows(rows) {}
+
+    auto size() const noexcept -> size_t { return rows; }
+    bool empty() const noexcept { return rows == 0; }
+    auto plane(size_t k) const noexcept -> const Word * { return planes[k]; }
+
+private:
+    Planes planes{};
+    size_t rows{};
+};
+
+// Contiguous column of flags with bulk queries
+// F is one of classic::Flags, bitnumber::Flags, tagtype::Flags, tagvalue::Flags or repeated::Flags
+//
+// Flags are split into planes of unsigned words (structure of arrays):
+// flags up to 64 bits use one plane of the matching word size, wider flags one uint64_t plane per word.
+// Every plane is padded to whole blocks of 64 rows, so the scan kernels never handle a partial vector.
+//
+//     auto cats = animals.count_all(Animal::Cat);                          // rows with Cat
+//     auto tame = animals.count_all_none(Animal::Cat, Animal::Wolf);       // Cat and not Wolf
+//     auto rows = animals.bitmap_any(Animal::Cat | Animal::Dog);          // bit i set for every matching row i
+template<class F>
+struct FlagsVector : details::FlagsQueries<FlagsVector<F>, F> {
+    using This = FlagsVector;
+    using Base = details::FlagsQueries<FlagsVector<F>, F>;
+    using Word = typename Base::Word;
+    static constexpr auto planeCount = Base::planeCount;
+
+    FlagsVector() = default;
+    explicit FlagsVector(size_t n) { resize(n); }
+    FlagsVector(std::initializer_list<F> fs) {
+        reserve(fs.size());
+        for (auto f : fs) push_back(f);
+    }
+
+    auto size() const noexcept -> size_t { return rows; }
+    bool empty() const noexcept { return rows == 0; }
+
+    // raw plane k, padded with empty flags to a multiple of 64 rows
+    // Bit b of the flags is bit b % wordBits of plane b / wordBits.
+    auto plane(size_t k) const noexcept -> const Word * { return planes[k].data(); }
+    auto plane(size_t k) noexcept -> Word * { return planes[k].data(); }
+
+    // read-only view, valid until the vector is resized
+    auto view() const noexcept -> FlagsView<F> {
+        auto r = typename FlagsView<F>::Planes{};
+        for (auto k = size_t{}; k < planeCount; k++) r[k] = planes[k].data();
+        return {r, rows};
+    }
+
+    void reserve(size_t n) {
+        for (auto &p : planes) p.reserve(Base::paddedRows(n));
+    }
+    // new rows are empty
+    void resize(size_t n) {
+        for (auto &p : planes) {
+            // shrinking keeps the padding empty
+            if (n < rows) std::fill(p.begin() + n, p.begin() + rows, Word{});
+            p.resize(Base::paddedRows(n));
+        }
+        rows = n;
+    }
+    void clear() noexcept {
+        for (auto &p : planes) p.clear();
+        rows = 0;
+    }
+
+    void push_back(F f) {
+        if (rows % details::blockRows == 0) resize(rows + 1);
+        else
+            rows++;
+        set(rows - 1, f);
+    }
+
+    void set(size_t i, F f) noexcept {
+        const auto w = Base::toWords(f);
+        for (auto k = size_t{}; k < planeCount; k++) planes[k][i] = w[k];
+    }
+
+private:
+    std::array<std::vector<Word>, planeCount> planes{};
+    size_t rows{};
+};
+
+} // namespace columnar
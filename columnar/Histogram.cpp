@@ -0,0 +1,7 @@
+#include "Histogram.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
@@ -0,0 +1,65 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace columnar {
+
+// Number of values with each flag set, for plain arrays of any flags flavour
+//
+//     auto perFlag = columnar::histogram(animals);                  // std::vector<Animals>
+//     auto cats = perFlag[Animals::indexOf(Animal::Cat)];
+//
+// The array is read as a stream of uint64_t words and counted with a vertical popcount (Harley-Seal),
+// so the cost does not depend on the number of set flags.
+// Flags wider than 64 bits are split into their words first.
+template<class F>
+auto histogram(const F *flags, size_t n) noexcept -> FlagHistogram<F> {
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+    static_assert(sizeof(F) <= sizeof(uint64_t) ? sizeof(uint64_t) % sizeof(F) == 0 : sizeof(F) % sizeof(uint64_t) == 0,
+                  "flags have to be a whole number of words");
+    auto r = FlagHistogram<F>{};
+    const auto bytes = static_cast<const unsigned char *>(static_cast<const void *>(flags));
+
+    if constexpr (sizeof(F) <= sizeof(uint64_t)) {
+        const auto words = n * sizeof(F) / sizeof(uint64_t);
+        auto counter = details::PositionalCount{};
+        counter.add(bytes, words);
+        // the last values do not fill a whole word, the rest of the word stays empty
+        if (const auto rest = n * sizeof(F) - words * sizeof(uint64_t); rest != 0) {
+            auto tail = uint64_t{};
+            std::memcpy(&tail, bytes + words * sizeof(uint64_t), rest);
+            counter.add(&tail, 1);
+        }
+        details::addPositions(counter.result(), sizeof(F) * 8, 0, r);
+    }
+    else {
+        constexpr auto wordCount = sizeof(F) / sizeof(uint64_t);
+        constexpr auto chunk = size_t{256};
+        std::array<details::PositionalCount, wordCount> counters{};
+        uint64_t gathered[chunk];
+        for (auto first = size_t{}; first < n; first += chunk) {
+            const auto count = std::min(chunk, n - first);
+            for (auto k = size_t{}; k < wordCount; k++) {
+                for (auto i = size_t{}; i < count; i++)
+                    std::memcpy(&gathered[i], bytes + (first + i) * sizeof(F) + k * sizeof(uint64_t), sizeof(uint64_t));
+                counters[k].add(gathered, count);
+            }
+        }
+        for (auto k = size_t{}; k < wordCount; k++) details::addPositions(counters[k].result(), 64, k * 64, r);
+    }
+    return r;
+}
+
+template<class F>
+auto histogram(const std::vector<F> &flags) noexcept -> FlagHistogram<F> {
+    return histogram(flags.data(), flags.size());
+}
+
+} // namespace columnar
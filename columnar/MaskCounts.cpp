@@ -0,0 +1,7 @@
+#include "MaskCounts.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
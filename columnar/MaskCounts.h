@@ -0,0 +1,127 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include "meta/details/BitStorage.h"
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace columnar {
+
+// Record counts for every mask of a small flags type (tagtype, tagvalue or repeated with up to 20 flags)
+//
+// Three tables with one entry per mask m:
+// * exact    - records equal to m
+// * superset - records containing m (zeta transform over supersets), answers count_all
+// * subset   - records contained in m (zeta transform over subsets), answers count_none via the complement
+// Built in O(n 2^n), afterwards count_all/any/none are single lookups.
+// Changing a record with k flags updates 2^k superset and 2^(n-k) subset entries.
+template<class F, class Count = uint32_t>
+struct MaskCounts {
+    using This = MaskCounts;
+    using Flags = F;
+    static constexpr auto bitCount = size_t{F::bitCount};
+    static_assert(bitCount <= 20, "MaskCounts keeps 2^bitCount entries per table");
+    static constexpr auto maskCount = size_t{1} << bitCount;
+    static constexpr auto full = static_cast<uint32_t>(maskCount - 1);
+
+    MaskCounts()
+        : exact(maskCount)
+        , superset(maskCount)
+        , subset(maskCount) {}
+
+    explicit MaskCounts(const FlagsVector<F> &v)
+        : MaskCounts() {
+        for (auto i = size_t{}; i < v.size(); i++) exact[maskOf(v[i])]++;
+        total = v.size();
+        rebuild();
+    }
+
+    template<class It>
+    MaskCounts(It first, It last)
+        : MaskCounts() {
+        for (; first != last; ++first, ++total) exact[maskOf(*first)]++;
+        rebuild();
+    }
+
+    auto size() const noexcept -> uint64_t { return total; }
+
+    auto count_exact(F f) const noexcept -> Count { return exact[maskOf(f)]; }
+    auto count_all(F mask) const noexcept -> Count { return superset[maskOf(mask)]; }
+    auto count_none(F mask) const noexcept -> Count { return subset[full & ~maskOf(mask)]; }
+    auto count_any(F mask) const noexcept -> Count { return static_cast<Count>(total - count_none(mask)); }
+
+    // Records with all of all and none of none, by inclusion-exclusion (Möbius) over the subsets of none
+    // Costs 2^popcount(none) lookups.
+    auto count_all_none(F all, F none) const noexcept -> Count {
+        const auto a = maskOf(all);
+        const auto n = maskOf(none);
+        if ((n & a) != 0) return 0;
+        auto r = int64_t{};
+        for (auto s = n;; s = (s - 1) & n) {
+            const auto sign = details::countSetBits(s) % 2 ? -1 : 1;
+            r += sign * static_cast<int64_t>(superset[a | s]);
+            if (s == 0) break;
+        }
+        return static_cast<Count>(r);
+    }
+
+    void add(F f) noexcept { change(maskOf(f), true); }
+    void remove(F f) noexcept { change(maskOf(f), false); }
+    void update(F from, F to) noexcept {
+        if (from == to) return;
+        remove(from);
+        add(to);
+    }
+
+private:
+    static auto maskOf(F f) noexcept -> uint32_t {
+        using Word = decltype(meta::details::SelectBitWord<sizeof(F) * 8>());
+        static_assert(sizeof(Word) == sizeof(F), "flags have to be the size of a word");
+        auto w = Word{};
+        std::memcpy(&w, &f, sizeof(F));
+        return static_cast<uint32_t>(w) & full;
+    }
+
+    void rebuild() noexcept {
+        superset = exact;
+        subset = exact;
+        for (auto b = size_t{}; b < bitCount; b++) {
+            const auto bit = uint32_t{1} << b;
+            for (auto m = uint32_t{}; m < maskCount; m++) {
+                if (m & bit)
+                    subset[m] += subset[m ^ bit];
+                else
+                    superset[m] += superset[m | bit];
+            }
+        }
+    }
+
+    // counts are unsigned, removing adds the wrapped -1
+    void change(uint32_t m, bool added) noexcept {
+        const auto delta = added ? Count{1} : static_cast<Count>(-1);
+        total = added ? total + 1 : total - 1;
+        exact[m] += delta;
+        // every subset of m gains a superset record
+        for (auto s = m;; s = (s - 1) & m) {
+            superset[s] += delta;
+            if (s == 0) break;
+        }
+        // every superset of m gains a subset record
+        const auto rest = full & ~m;
+        for (auto s = rest;; s = (s - 1) & rest) {
+            subset[m | s] += delta;
+            if (s == 0) break;
+        }
+    }
+
+private:
+    std::vector<Count> exact;
+    std::vector<Count> superset;
+    std::vector<Count> subset;
+    uint64_t total{};
+};
+
+} // namespace columnar
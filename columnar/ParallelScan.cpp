@@ -0,0 +1,7 @@
+#include "ParallelScan.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
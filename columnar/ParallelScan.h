@@ -0,0 +1,167 @@
+#pragma once
+#include "FlagsVector.h"
+#include "ScanPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace columnar {
+
+// Bulk queries of a FlagsVector or FlagsView spread over a ScanPool
+//
+// The rows are cut into morsels of morselRows rows (a few KiB per plane, so a morsel stays in L1/L2).
+// Every worker accumulates into its own WorkerSlot, the slots are combined once the pool is done.
+// Bitmaps are written directly, morsels cover disjoint words.
+//
+//     auto pool = columnar::ScanPool{};
+//     auto scan = columnar::ParallelScan<Animals>{pool, animals};
+//     auto tame = scan.count_all_none(Animal::Cat, Animal::Wolf);
+//     auto seen = scan.reduce_or();        // every flag set in any row
+//     auto perFlag = scan.histogram();     // rows per flag index
+template<class F>
+struct ParallelScan {
+    using This = ParallelScan;
+    using Flags = F;
+    using Vector = FlagsVector<F>;
+    using Word = typename Vector::Word;
+    static constexpr auto planeCount = Vector::planeCount;
+    static constexpr auto flagCount = Vector::flagCount;
+    static constexpr auto morselRows = size_t{16384};
+    using Histogram = FlagHistogram<F>;
+
+    ParallelScan(ScanPool &pool, FlagsView<F> column) noexcept
+        : pool(&pool)
+        , column(column) {}
+    ParallelScan(ScanPool &pool, const Vector &vector) noexcept
+        : ParallelScan(pool, vector.view()) {}
+
+    auto count_all(F mask) const -> size_t { return count({toWords(mask), {}}); }
+    auto count_any(F mask) const -> size_t { return column.size() - count_none(mask); }
+    auto count_none(F mask) const -> size_t { return count({{}, toWords(mask)}); }
+    auto count_all_none(F all, F none) const -> size_t { return count({toWords(all), toWords(none)}); }
+
+    // Writes one bit per row to out, out needs room for bitmapWords() words of the column
+    void bitmap_all(F mask, uint64_t *out) const { bitmap({toWords(mask), {}}, false, out); }
+    void bitmap_any(F mask, uint64_t *out) const { bitmap({{}, toWords(mask)}, true, out); }
+    void bitmap_none(F mask, uint64_t *out) const { bitmap({{}, toWords(mask)}, false, out); }
+    void bitmap_all_none(F all, F none, uint64_t *out) const { bitmap({toWords(all), toWords(none)}, false, out); }
+
+    auto bitmap_all(F mask) const -> std::vector<uint64_t> { return bitmap({toWords(mask), {}}, false); }
+    auto bitmap_any(F mask) const -> std::vector<uint64_t> { return bitmap({{}, toWords(mask)}, true); }
+    auto bitmap_none(F mask) const -> std::vector<uint64_t> { return bitmap({{}, toWords(mask)}, false); }
+    auto bitmap_all_none(F all, F none) const -> std::vector<uint64_t> {
+        return bitmap({toWords(all), toWords(none)}, false);
+    }
+
+    // flags set in any row, empty flags for no rows
+    auto reduce_or() const -> F { return reduce(false); }
+    // flags set in every row, empty flags for no rows
+    auto reduce_and() const -> F { return reduce(true); }
+
+    // number of rows with flag index b at [b], every worker runs a vertical popcount over its morsels
+    auto histogram() const -> Histogram {
+        using Counters = std::array<details::PositionalCount, planeCount>;
+        auto slots = std::vector<WorkerSlot<Counters>>(pool->threadCount());
+        forMorsels([&](size_t worker, size_t first, size_t last) {
+            for (auto k = size_t{}; k < planeCount; k++)
+                details::countPlaneRows(slots[worker].value[k], column.plane(k), first, last);
+        });
+        auto r = Histogram{};
+        for (auto &s : slots)
+            for (auto k = size_t{}; k < planeCount; k++)
+                details::addPositions(s.value[k].result(), Vector::wordBits, k * Vector::wordBits, r);
+        return r;
+    }
+
+private:
+    using Predicate = details::Predicate<Word, planeCount>;
+    using Words = std::array<Word, planeCount>;
+    static constexpr auto morselBlocks = morselRows / details::blockRows;
+
+    static auto toWords(F f) noexcept -> Words {
+        auto r = Words{};
+        std::memcpy(r.data(), &f, sizeof(F));
+        return r;
+    }
+
+    auto columns() const noexcept -> details::Columns<Word, planeCount> {
+        auto r = details::Columns<Word, planeCount>{};
+        for (auto k = size_t{}; k < planeCount; k++) r[k] = column.plane(k);
+        return r;
+    }
+
+    // Calls fn(worker, firstRow, lastRow) for every morsel, the last one ends at size()
+    template<class Fn>
+    void forMorsels(Fn &&fn) const {
+        const auto rows = column.size();
+        pool->run((rows + morselRows - 1) / morselRows, [&](size_t worker, size_t m) {
+            fn(worker, m * morselRows, std::min(rows, (m + 1) * morselRows));
+        });
+    }
+
+    // Calls fn(worker, block, rowBits) for every block of 64 rows
+    template<class Fn>
+    void forBlocks(const Predicate &p, bool invert, Fn &&fn) const {
+        const auto c = columns();
+        const auto rows = column.size();
+        forMorsels([&](size_t worker, size_t first, size_t last) {
+            for (auto b = first / details::blockRows; b * details::blockRows < last; b++) {
+                const auto row = b * details::blockRows;
+                const auto m = details::matchBlock(c, p, row);
+                fn(worker, b, (invert ? ~m : m) & details::blockMask(rows - row));
+            }
+        });
+    }
+
+    auto count(const Predicate &p) const -> size_t {
+        auto slots = std::vector<WorkerSlot<size_t>>(pool->threadCount());
+        forBlocks(p, false, [&](size_t worker, size_t, uint64_t m) { slots[worker].value += details::countSetBits(m); });
+        auto r = size_t{};
+        for (const auto &s : slots) r += s.value;
+        return r;
+    }
+
+    void bitmap(const Predicate &p, bool invert, uint64_t *out) const {
+        forBlocks(p, invert, [&](size_t, size_t b, uint64_t m) { out[b] = m; });
+    }
+    auto bitmap(const Predicate &p, bool invert) const -> std::vector<uint64_t> {
+        auto r = std::vector<uint64_t>(column.bitmapWords());
+        bitmap(p, invert, r.data());
+        return r;
+    }
+
+    auto reduce(bool all) const -> F {
+        const auto start = all ? static_cast<Word>(~Word{}) : Word{};
+        auto slots = std::vector<WorkerSlot<Words>>(pool->threadCount());
+        for (auto &s : slots) s.value.fill(start);
+        forMorsels([&](size_t worker, size_t first, size_t last) {
+            auto &w = slots[worker].value;
+            for (auto k = size_t{}; k < planeCount; k++) {
+                const auto plane = column.plane(k);
+                auto v = w[k];
+                if (all)
+                    for (auto i = first; i < last; i++) v &= plane[i];
+                else
+                    for (auto i = first; i < last; i++) v |= plane[i];
+                w[k] = v;
+            }
+        });
+        auto w = Words{};
+        w.fill(column.empty() ? Word{} : start);
+        for (const auto &s : slots)
+            for (auto k = size_t{}; k < planeCount; k++) w[k] = all ? w[k] & s.value[k] : w[k] | s.value[k];
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), w.data(), sizeof(F));
+        return r;
+    }
+
+private:
+    ScanPool *pool{};
+    FlagsView<F> column{};
+};
+
+} // namespace columnar
@@ -0,0 +1,399 @@
+#include "RoaringBitmap.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace columnar {
+
+using details::RoaringContainer;
+using Kind = RoaringContainer::Kind;
+
+bool RoaringContainer::contains(uint16_t v) const noexcept {
+    switch (kind) {
+    case Kind::Array: return std::binary_search(values.begin(), values.end(), v);
+    case Kind::Bitmap: return (words[v / 64] >> (v % 64)) & 1;
+    case Kind::Run: {
+        // last run starting at or before v
+        auto lo = size_t{}, hi = values.size() / 2;
+        while (lo < hi) {
+            const auto mid = (lo + hi) / 2;
+            if (values[2 * mid] <= v)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo > 0 && v <= values[2 * lo - 1];
+    }
+    }
+    return false;
+}
+
+namespace {
+
+auto fromWords(std::vector<uint64_t> &&words) -> RoaringContainer {
+    auto c = RoaringContainer{};
+    for (auto w : words) c.cardinality += static_cast<uint32_t>(details::countSetBits(w));
+    if (c.cardinality > RoaringContainer::arrayLimit) {
+        c.kind = Kind::Bitmap;
+        c.words = std::move(words);
+        return c;
+    }
+    c.kind = Kind::Array;
+    c.values.reserve(c.cardinality);
+    for (auto k = size_t{}; k < words.size(); k++)
+        for (auto w = words[k]; w != 0; w &= w - 1)
+            c.values.push_back(static_cast<uint16_t>(k * 64 + details::countTrailingZeros(w)));
+    return c;
+}
+
+auto toWords(const RoaringContainer &c) -> std::vector<uint64_t> {
+    if (c.kind == Kind::Bitmap) return c.words;
+    auto words = std::vector<uint64_t>(RoaringContainer::bitmapWords);
+    c.each([&](uint16_t v) { words[v / 64] |= uint64_t{1} << (v % 64); });
+    return words;
+}
+
+// bitmap words of c, converted into buffer unless c already is a bitmap
+auto wordsOf(const RoaringContainer &c, std::vector<uint64_t> &buffer) -> const uint64_t * {
+    if (c.kind == Kind::Bitmap) return c.words.data();
+    buffer = toWords(c);
+    return buffer.data();
+}
+
+auto fromArray(std::vector<uint16_t> &&values) -> RoaringContainer {
+    if (values.size() > RoaringContainer::arrayLimit) {
+        auto words = std::vector<uint64_t>(RoaringContainer::bitmapWords);
+        for (auto v : values) words[v / 64] |= uint64_t{1} << (v % 64);
+        return fromWords(std::move(words));
+    }
+    auto c = RoaringContainer{};
+    c.kind = Kind::Array;
+    c.cardinality = static_cast<uint32_t>(values.size());
+    c.values = std::move(values);
+    return c;
+}
+
+auto fromRange(uint32_t first, uint32_t last) -> RoaringContainer {
+    auto c = RoaringContainer{};
+    c.kind = Kind::Run;
+    c.cardinality = last - first + 1;
+    c.values = {static_cast<uint16_t>(first), static_cast<uint16_t>(last)};
+    return c;
+}
+
+auto runCount(const RoaringContainer &c) -> size_t {
+    switch (c.kind) {
+    case Kind::Run: return c.values.size() / 2;
+    case Kind::Array: {
+        auto runs = size_t{};
+        for (auto i = size_t{}; i < c.values.size(); i++) runs += i == 0 || c.values[i] != c.values[i - 1] + 1;
+        return runs;
+    }
+    case Kind::Bitmap: {
+        // a run starts at every set bit whose lower neighbour is clear
+        auto runs = size_t{};
+        auto carry = uint64_t{};
+        for (auto w : c.words) {
+            runs += details::countSetBits(w & ~((w << 1) | carry));
+            carry = w >> 63;
+        }
+        return runs;
+    }
+    }
+    return 0;
+}
+
+auto toRuns(const RoaringContainer &c) -> RoaringContainer {
+    auto r = RoaringContainer{};
+    r.kind = Kind::Run;
+    r.cardinality = c.cardinality;
+    c.each([&](uint16_t v) {
+        if (!r.values.empty() && r.values.back() + 1 == v)
+            r.values.back() = v;
+        else
+            r.values.insert(r.values.end(), {v, v});
+    });
+    return r;
+}
+
+// array or bitmap form of c
+auto materialized(const RoaringContainer &c) -> RoaringContainer {
+    if (c.kind != Kind::Run) return c;
+    return fromWords(toWords(c));
+}
+
+// array values of a that are (keep) or are not (!keep) in b
+auto filter(const RoaringContainer &a, const RoaringContainer &b, bool keep) -> RoaringContainer {
+    auto values = std::vector<uint16_t>{};
+    for (auto v : a.values)
+        if (b.contains(v) == keep) values.push_back(v);
+    return fromArray(std::move(values));
+}
+
+// overlaps of the runs of a and b, both sorted and disjoint
+auto intersectRuns(const RoaringContainer &a, const RoaringContainer &b) -> RoaringContainer {
+    auto r = RoaringContainer{};
+    r.kind = Kind::Run;
+    for (auto i = size_t{}, j = size_t{}; i < a.values.size() && j < b.values.size();) {
+        const auto first = std::max(a.values[i], b.values[j]);
+        const auto last = std::min(a.values[i + 1], b.values[j + 1]);
+        if (first <= last) {
+            r.values.insert(r.values.end(), {first, last});
+            r.cardinality += last - first + 1u;
+        }
+        // the run that ends first can not overlap any later run of the other
+        if (a.values[i + 1] < b.values[j + 1])
+            i += 2;
+        else
+            j += 2;
+    }
+    return r;
+}
+
+// runs of a and b in start order, touching and overlapping runs joined
+auto uniteRuns(const RoaringContainer &a, const RoaringContainer &b) -> RoaringContainer {
+    auto r = RoaringContainer{};
+    r.kind = Kind::Run;
+    for (auto i = size_t{}, j = size_t{}; i < a.values.size() || j < b.values.size();) {
+        const auto fromA = j == b.values.size() || (i < a.values.size() && a.values[i] < b.values[j]);
+        const auto first = fromA ? a.values[i] : b.values[j];
+        const auto last = fromA ? a.values[i + 1] : b.values[j + 1];
+        (fromA ? i : j) += 2;
+        if (!r.values.empty() && first <= r.values.back() + 1u)
+            r.values.back() = std::max(r.values.back(), last);
+        else
+            r.values.insert(r.values.end(), {first, last});
+    }
+    for (auto k = size_t{}; k < r.values.size(); k += 2) r.cardinality += r.values[k + 1] - r.values[k] + 1u;
+    return r;
+}
+
+auto intersect(const RoaringContainer &a, const RoaringContainer &b) -> RoaringContainer {
+    if (a.kind == Kind::Run && b.kind == Kind::Run) return intersectRuns(a, b);
+    if (a.kind == Kind::Array && b.kind == Kind::Array) {
+        auto values = std::vector<uint16_t>{};
+        std::set_intersection(
+            a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+        return fromArray(std::move(values));
+    }
+    if (a.kind == Kind::Array) return filter(a, b, true);
+    if (b.kind == Kind::Array) return filter(b, a, true);
+    auto words = toWords(a);
+    auto buffer = std::vector<uint64_t>{};
+    const auto o = wordsOf(b, buffer);
+    for (auto k = size_t{}; k < words.size(); k++) words[k] &= o[k];
+    return fromWords(std::move(words));
+}
+
+auto unite(const RoaringContainer &a, const RoaringContainer &b) -> RoaringContainer {
+    if (a.kind == Kind::Run && b.kind == Kind::Run) return uniteRuns(a, b);
+    if (a.kind == Kind::Array && b.kind == Kind::Array) {
+        auto values = std::vector<uint16_t>{};
+        values.reserve(a.values.size() + b.values.size());
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+        return fromArray(std::move(values));
+    }
+    auto words = toWords(a.kind == Kind::Array ? b : a);
+    const auto &other = a.kind == Kind::Array ? a : b;
+    if (other.kind == Kind::Array) {
+        for (auto v : other.values) words[v / 64] |= uint64_t{1} << (v % 64);
+    }
+    else {
+        auto buffer = std::vector<uint64_t>{};
+        const auto o = wordsOf(other, buffer);
+        for (auto k = size_t{}; k < words.size(); k++) words[k] |= o[k];
+    }
+    return fromWords(std::move(words));
+}
+
+auto subtract(const RoaringContainer &a, const RoaringContainer &b) -> RoaringContainer {
+    if (a.kind == Kind::Array && b.kind == Kind::Array) {
+        auto values = std::vector<uint16_t>{};
+        std::set_difference(
+            a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+        return fromArray(std::move(values));
+    }
+    if (a.kind == Kind::Array) return filter(a, b, false);
+    auto words = toWords(a);
+    if (b.kind == Kind::Array) {
+        for (auto v : b.values) words[v / 64] &= ~(uint64_t{1} << (v % 64));
+    }
+    else {
+        auto buffer = std::vector<uint64_t>{};
+        const auto o = wordsOf(b, buffer);
+        for (auto k = size_t{}; k < words.size(); k++) words[k] &= ~o[k];
+    }
+    return fromWords(std::move(words));
+}
+
+} // namespace
+
+auto RoaringBitmap::range(uint32_t first, uint32_t last) -> This {
+    auto r = This{};
+    if (first >= last) return r;
+    for (auto key = first >> 16; key <= (last - 1) >> 16; key++) {
+        const auto lo = key == first >> 16 ? first & 0xffff : 0;
+        const auto hi = key == (last - 1) >> 16 ? (last - 1) & 0xffff : 0xffff;
+        r.push(static_cast<uint16_t>(key), fromRange(lo, hi));
+    }
+    return r;
+}
+
+void RoaringBitmap::push(uint16_t key, Container &&c) {
+    keys.push_back(key);
+    containers.push_back(std::move(c));
+}
+
+void RoaringBitmap::add(uint32_t v) {
+    const auto key = static_cast<uint16_t>(v >> 16);
+    const auto low = static_cast<uint16_t>(v & 0xffff);
+
+    auto i = keys.size();
+    if (keys.empty() || keys.back() < key) {
+        // i is the index of the new container
+        push(key, fromArray({}));
+    }
+    else if (keys.back() == key) {
+        i = keys.size() - 1;
+    }
+    else {
+        i = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+        if (keys[i] != key) {
+            keys.insert(keys.begin() + static_cast<ptrdiff_t>(i), key);
+            containers.insert(containers.begin() + static_cast<ptrdiff_t>(i), fromArray({}));
+        }
+    }
+
+    auto &c = containers[i];
+    if (c.kind == Kind::Run) {
+        if (c.contains(low)) return;
+        c = materialized(c);
+    }
+    if (c.kind == Kind::Bitmap) {
+        auto &w = c.words[low / 64];
+        const auto bit = uint64_t{1} << (low % 64);
+        c.cardinality += (w & bit) == 0;
+        w |= bit;
+        return;
+    }
+    // appending is the common case while building an index row by row
+    if (c.values.empty() || c.values.back() < low) {
+        c.values.push_back(low);
+    }
+    else {
+        const auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+        if (*it == low) return;
+        c.values.insert(it, low);
+    }
+    c.cardinality++;
+    if (c.values.size() > Container::arrayLimit) c = fromArray(std::move(c.values));
+}
+
+bool RoaringBitmap::contains(uint32_t v) const noexcept {
+    const auto key = static_cast<uint16_t>(v >> 16);
+    const auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) return false;
+    return containers[static_cast<size_t>(it - keys.begin())].contains(static_cast<uint16_t>(v & 0xffff));
+}
+
+auto RoaringBitmap::cardinality() const noexcept -> uint64_t {
+    auto r = uint64_t{};
+    for (const auto &c : containers) r += c.cardinality;
+    return r;
+}
+
+void RoaringBitmap::optimize() {
+    for (auto &c : containers) {
+        const auto runBytes = runCount(c) * 2 * sizeof(uint16_t);
+        const auto arrayBytes = size_t{c.cardinality} * sizeof(uint16_t);
+        const auto bitmapBytes = Container::bitmapWords * sizeof(uint64_t);
+        if (runBytes < std::min(arrayBytes, bitmapBytes)) {
+            if (c.kind != Kind::Run) c = toRuns(c);
+        }
+        else if (c.kind == Kind::Run) {
+            c = materialized(c);
+        }
+        c.values.shrink_to_fit();
+    }
+}
+
+auto RoaringBitmap::bytes() const noexcept -> size_t {
+    auto r = sizeof(This) + keys.capacity() * sizeof(uint16_t) + containers.capacity() * sizeof(Container);
+    for (const auto &c : containers) r += c.values.capacity() * sizeof(uint16_t) + c.words.capacity() * sizeof(uint64_t);
+    return r;
+}
+
+auto RoaringBitmap::values() const -> std::vector<uint32_t> {
+    auto r = std::vector<uint32_t>{};
+    r.reserve(cardinality());
+    each([&](uint32_t v) { r.push_back(v); });
+    return r;
+}
+
+auto RoaringBitmap::operator&(const This &o) const -> This {
+    auto r = This{};
+    for (auto i = size_t{}, j = size_t{}; i < keys.size() && j < o.keys.size();) {
+        if (keys[i] < o.keys[j]) {
+            i++;
+        }
+        else if (keys[i] > o.keys[j]) {
+            j++;
+        }
+        else {
+            auto c = intersect(containers[i], o.containers[j]);
+            if (c.cardinality != 0) r.push(keys[i], std::move(c));
+            i++, j++;
+        }
+    }
+    return r;
+}
+
+auto RoaringBitmap::operator|(const This &o) const -> This {
+    auto r = This{};
+    auto i = size_t{}, j = size_t{};
+    while (i < keys.size() || j < o.keys.size()) {
+        if (j == o.keys.size() || (i < keys.size() && keys[i] < o.keys[j])) {
+            r.push(keys[i], Container{containers[i]});
+            i++;
+        }
+        else if (i == keys.size() || keys[i] > o.keys[j]) {
+            r.push(o.keys[j], Container{o.containers[j]});
+            j++;
+        }
+        else {
+            r.push(keys[i], unite(containers[i], o.containers[j]));
+            i++, j++;
+        }
+    }
+    return r;
+}
+
+auto RoaringBitmap::operator-(const This &o) const -> This {
+    auto r = This{};
+    auto j = size_t{};
+    for (auto i = size_t{}; i < keys.size(); i++) {
+        while (j < o.keys.size() && o.keys[j] < keys[i]) j++;
+        if (j == o.keys.size() || o.keys[j] != keys[i]) {
+            r.push(keys[i], Container{containers[i]});
+            continue;
+        }
+        auto c = subtract(containers[i], o.containers[j]);
+        if (c.cardinality != 0) r.push(keys[i], std::move(c));
+    }
+    return r;
+}
+
+bool RoaringBitmap::operator==(const This &o) const {
+    if (keys != o.keys) return false;
+    for (auto i = size_t{}; i < keys.size(); i++) {
+        const auto &a = containers[i];
+        const auto &b = o.containers[i];
+        if (a.cardinality != b.cardinality) return false;
+        if (a.kind == b.kind && a.values == b.values && a.words == b.words) continue;
+        if (toWords(a) != toWords(b)) return false;
+    }
+    return true;
+}
+
+} // namespace columnar
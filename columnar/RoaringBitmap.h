@@ -0,0 +1,104 @@
+#pragma once
+#include "details/ScanKernels.h"
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace columnar {
+
+namespace details {
+
+// One chunk of 65536 values of a RoaringBitmap
+struct RoaringContainer {
+    enum class Kind : uint8_t { Array, Bitmap, Run };
+    static constexpr auto arrayLimit = size_t{4096};
+    static constexpr auto bitmapWords = size_t{1024};
+
+    Kind kind{};
+    uint32_t cardinality{};
+    std::vector<uint16_t> values{}; // Array: sorted values, Run: pairs of first and last value
+    std::vector<uint64_t> words{};  // Bitmap: one bit per value
+
+    bool contains(uint16_t v) const noexcept;
+
+    template<class Fn>
+    void each(Fn &&fn) const {
+        switch (kind) {
+        case Kind::Array:
+            for (auto v : values) fn(v);
+            break;
+        case Kind::Bitmap:
+            for (auto k = size_t{}; k < words.size(); k++)
+                for (auto w = words[k]; w != 0; w &= w - 1) fn(static_cast<uint16_t>(k * 64 + countTrailingZeros(w)));
+            break;
+        case Kind::Run:
+            for (auto k = size_t{}; k < values.size(); k += 2)
+                for (auto v = uint32_t{values[k]}; v <= values[k + 1]; v++) fn(static_cast<uint16_t>(v));
+            break;
+        }
+    }
+};
+
+} // namespace details
+
+// Compressed set of 32 bit values (row numbers)
+//
+// Values are split by their upper 16 bits into containers that adapt to their density:
+// * Array  - sorted 16 bit values, up to 4096 of them
+// * Bitmap - 65536 bits for denser chunks
+// * Run    - first/last pairs, chosen by optimize() when the chunk has few long runs
+// Set operations combine the containers chunk by chunk.
+// Two arrays stay sparse and two runs stay runs, all other pairs meet as bitmap words and shrink back to arrays.
+struct RoaringBitmap {
+    using This = RoaringBitmap;
+    using Container = details::RoaringContainer;
+
+    RoaringBitmap() = default;
+
+    // all values in [first, last)
+    static auto range(uint32_t first, uint32_t last) -> This;
+
+    // fastest when values arrive in ascending order
+    void add(uint32_t v);
+    bool contains(uint32_t v) const noexcept;
+
+    auto cardinality() const noexcept -> uint64_t;
+    bool empty() const noexcept { return keys.empty(); }
+
+    // converts every container to its smallest representation (including runs)
+    void optimize();
+    // heap and container memory in bytes
+    auto bytes() const noexcept -> size_t;
+
+    // calls fn(value) in ascending order
+    template<class Fn>
+    void each(Fn &&fn) const {
+        for (auto i = size_t{}; i < keys.size(); i++) {
+            const auto base = uint32_t{keys[i]} << 16;
+            containers[i].each([&](uint16_t low) { fn(base | low); });
+        }
+    }
+    auto values() const -> std::vector<uint32_t>;
+
+    // intersection, union and difference
+    auto operator&(const This &o) const -> This;
+    auto operator|(const This &o) const -> This;
+    auto operator-(const This &o) const -> This;
+
+    auto operator&=(const This &o) -> This & { return *this = *this & o; }
+    auto operator|=(const This &o) -> This & { return *this = *this | o; }
+    auto operator-=(const This &o) -> This & { return *this = *this - o; }
+
+    bool operator==(const This &o) const;
+    bool operator!=(const This &o) const { return !(*this == o); }
+
+private:
+    void push(uint16_t key, Container &&c);
+
+private:
+    std::vector<uint16_t> keys{};
+    std::vector<Container> containers{};
+};
+
+} // namespace columnar
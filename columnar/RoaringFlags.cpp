@@ -0,0 +1,7 @@
+#include "RoaringFlags.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
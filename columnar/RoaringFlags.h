@@ -0,0 +1,126 @@
+#pragma once
+#include "FlagsVector.h"
+#include "RoaringBitmap.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+
+namespace columnar {
+
+// Compressed per-flag row index for sparse flags
+//
+// bitmap(b) holds the rows that have the flag with index b (its indexOf) as a RoaringBitmap.
+// Queries combine only the bitmaps they mention, the rarest first:
+//
+//     auto index = *RoaringFlags<F>::build(vector);
+//     auto rows = index.rows_all_none(Animal::Cat | Animal::Dog, Animal::Wolf);
+//     auto flags = index.materialize(rows);   // one F per matching row, in row order
+//
+// Rows are 32 bit numbers, build() returns nullopt for columns of more than maxRows rows.
+template<class F>
+struct RoaringFlags {
+    using This = RoaringFlags;
+    using Flags = F;
+    using Vector = FlagsVector<F>;
+    static constexpr auto flagCount = Vector::flagCount;
+    static constexpr auto maxRows = size_t{UINT32_MAX};
+
+    RoaringFlags() = default;
+
+    static auto build(const Vector &v) -> std::optional<This> {
+        if (v.size() > maxRows) return {};
+        auto r = This{};
+        r.rows = static_cast<uint32_t>(v.size());
+        for (auto k = size_t{}; k < Vector::planeCount; k++) {
+            const auto plane = v.plane(k);
+            for (auto i = uint32_t{}; i < r.rows; i++) {
+                for (auto w = uint64_t{plane[i]}; w != 0; w &= w - 1) {
+                    const auto b = k * Vector::wordBits + details::countTrailingZeros(w);
+                    if (b < flagCount) r.bitmaps[b].add(i);
+                }
+            }
+        }
+        for (auto &b : r.bitmaps) b.optimize();
+        return r;
+    }
+
+    auto size() const noexcept -> size_t { return rows; }
+    // memory of all bitmaps in bytes
+    auto bytes() const noexcept -> size_t {
+        auto r = sizeof(This);
+        for (const auto &b : bitmaps) r += b.bytes() - sizeof(RoaringBitmap);
+        return r;
+    }
+
+    auto bitmap(size_t b) const noexcept -> const RoaringBitmap & { return bitmaps[b]; }
+
+    auto operator[](uint32_t row) const noexcept -> F {
+        auto w = std::array<typename Vector::Word, Vector::planeCount>{};
+        for (auto b = size_t{}; b < flagCount; b++)
+            if (bitmaps[b].contains(row)) w[b / Vector::wordBits] |= uint64_t{1} << (b % Vector::wordBits);
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), w.data(), sizeof(F));
+        return r;
+    }
+
+    // rows with all flags of all and none of none
+    auto rows_all_none(F all, F none) const -> RoaringBitmap {
+        auto include = details::flagIndices(all);
+        auto r = RoaringBitmap{};
+        if (include.count == 0) {
+            r = RoaringBitmap::range(0, rows);
+        }
+        else {
+            // the smallest intermediate results come from intersecting the rarest flags first
+            std::sort(include.at.begin(), include.at.begin() + include.count, [&](size_t a, size_t b) {
+                return bitmaps[a].cardinality() < bitmaps[b].cardinality();
+            });
+            r = bitmaps[include.at[0]];
+            for (auto i = size_t{1}; i < include.count && !r.empty(); i++) r &= bitmaps[include.at[i]];
+        }
+        for (auto b : details::flagIndices(none)) {
+            if (r.empty()) break;
+            r -= bitmaps[b];
+        }
+        return r;
+    }
+    auto rows_all(F mask) const -> RoaringBitmap { return rows_all_none(mask, F{}); }
+    auto rows_any(F mask) const -> RoaringBitmap {
+        auto r = RoaringBitmap{};
+        for (auto b : details::flagIndices(mask)) r |= bitmaps[b];
+        return r;
+    }
+    auto rows_none(F mask) const -> RoaringBitmap { return rows_all_none(F{}, mask); }
+
+    auto count_all(F mask) const -> size_t { return rows_all(mask).cardinality(); }
+    auto count_any(F mask) const -> size_t { return rows_any(mask).cardinality(); }
+    auto count_none(F mask) const -> size_t { return rows - count_any(mask); }
+    auto count_all_none(F all, F none) const -> size_t { return rows_all_none(all, none).cardinality(); }
+
+    // Flags of the selected rows, row i of the result belongs to the i-th value of selection
+    auto materialize(const RoaringBitmap &selection) const -> Vector {
+        const auto positions = selection.values();
+        auto r = Vector(positions.size());
+        for (auto b = size_t{}; b < flagCount; b++) {
+            auto plane = r.plane(b / Vector::wordBits);
+            const auto bit = static_cast<typename Vector::Word>(uint64_t{1} << (b % Vector::wordBits));
+            // both sequences are ascending, so one cursor finds every position
+            auto cursor = positions.begin();
+            (selection & bitmaps[b]).each([&](uint32_t row) {
+                cursor = std::lower_bound(cursor, positions.end(), row);
+                plane[static_cast<size_t>(cursor - positions.begin())] |= bit;
+            });
+        }
+        return r;
+    }
+
+private:
+    std::array<RoaringBitmap, flagCount> bitmaps{};
+    uint32_t rows{};
+};
+
+} // namespace columnar
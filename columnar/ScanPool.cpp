@@ -0,0 +1,140 @@
+#include "ScanPool.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace columnar {
+
+namespace {
+
+// morsels [begin, end) of one worker, packed as begin << 32 | end
+struct alignas(details::cacheLineSize) Range {
+    std::atomic<uint64_t> bounds{};
+
+    static constexpr auto pack(uint64_t begin, uint64_t end) noexcept -> uint64_t { return begin << 32 | end; }
+    static constexpr auto begin(uint64_t b) noexcept -> uint64_t { return b >> 32; }
+    static constexpr auto end(uint64_t b) noexcept -> uint64_t { return b & 0xffffffff; }
+
+    // owner side, takes the first morsel
+    bool take(uint64_t &morsel) noexcept {
+        auto b = bounds.load(std::memory_order_relaxed);
+        while (begin(b) < end(b)) {
+            if (bounds.compare_exchange_weak(b, pack(begin(b) + 1, end(b)), std::memory_order_relaxed)) {
+                morsel = begin(b);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // thief side, removes the back half (at least one morsel)
+    bool steal(uint64_t &first, uint64_t &last) noexcept {
+        auto b = bounds.load(std::memory_order_relaxed);
+        while (begin(b) < end(b)) {
+            const auto split = end(b) - (end(b) - begin(b) + 1) / 2;
+            if (bounds.compare_exchange_weak(b, pack(begin(b), split), std::memory_order_relaxed)) {
+                first = split;
+                last = end(b);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+struct ScanPool::State {
+    std::vector<std::thread> threads{};
+    std::unique_ptr<Range[]> ranges{};
+    size_t count{};
+
+    std::mutex mutex{};
+    std::condition_variable wake{};
+    std::condition_variable done{};
+    uint64_t generation{};
+    size_t busy{};
+    bool stopping{};
+    Job job{};
+
+    void work(size_t worker) {
+        auto &own = ranges[worker];
+        auto morsel = uint64_t{};
+        for (;;) {
+            while (own.take(morsel)) job.call(job.context, worker, morsel);
+
+            // Only the owner refills its empty range, thieves never write an empty range.
+            auto first = uint64_t{};
+            auto last = uint64_t{};
+            auto stolen = false;
+            for (auto i = size_t{1}; i < count && !stolen; i++) stolen = ranges[(worker + i) % count].steal(first, last);
+            if (!stolen) return;
+            own.bounds.store(Range::pack(first + 1, last), std::memory_order_relaxed);
+            job.call(job.context, worker, first);
+        }
+    }
+
+    void loop(size_t worker) {
+        auto seen = uint64_t{};
+        for (;;) {
+            {
+                auto lock = std::unique_lock{mutex};
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work(worker);
+            auto lock = std::lock_guard{mutex};
+            if (--busy == 0) done.notify_one();
+        }
+    }
+};
+
+ScanPool::ScanPool(size_t threads)
+    : state(std::make_unique<State>()) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    state->count = threads;
+    state->ranges = std::make_unique<Range[]>(threads);
+    state->threads.reserve(threads - 1);
+    for (auto w = size_t{1}; w < threads; w++) state->threads.emplace_back([s = state.get(), w] { s->loop(w); });
+}
+
+ScanPool::~ScanPool() {
+    {
+        auto lock = std::lock_guard{state->mutex};
+        state->stopping = true;
+    }
+    state->wake.notify_all();
+    for (auto &t : state->threads) t.join();
+}
+
+auto ScanPool::threadCount() const noexcept -> size_t { return state->count; }
+
+void ScanPool::runJob(size_t morsels, Job job) {
+    if (morsels == 0) return;
+    auto &s = *state;
+    if (s.count == 1 || morsels == 1) {
+        for (auto m = size_t{}; m < morsels; m++) job.call(job.context, 0, m);
+        return;
+    }
+    for (auto w = size_t{}; w < s.count; w++)
+        s.ranges[w].bounds.store(Range::pack(morsels * w / s.count, morsels * (w + 1) / s.count), std::memory_order_relaxed);
+    {
+        // the mutex publishes the ranges and the job to the workers
+        auto lock = std::lock_guard{s.mutex};
+        s.job = job;
+        s.busy = s.count - 1;
+        s.generation++;
+    }
+    s.wake.notify_all();
+    s.work(0);
+    auto lock = std::unique_lock{s.mutex};
+    s.done.wait(lock, [&] { return s.busy == 0; });
+}
+
+} // namespace columnar
@@ -0,0 +1,62 @@
+#pragma once
+#include "meta/details/CacheLine.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace columnar {
+
+namespace details {
+
+using meta::details::cacheLineSize;
+
+} // namespace details
+
+// Per worker partial result on its own cache line
+template<class T>
+struct alignas(details::cacheLineSize) WorkerSlot {
+    T value{};
+};
+
+// Work stealing thread pool for bulk scans
+//
+// run(morsels, fn) hands every morsel number to exactly one worker:
+// * every worker starts with an equal contiguous range of morsels and takes them from the front
+// * an idle worker steals the back half of another range
+// Ranges are single atomic words, no locks are taken while morsels are distributed.
+// The calling thread works as worker 0, so a pool of one thread runs everything inline.
+struct ScanPool {
+    using This = ScanPool;
+
+    // threads includes the calling thread, 0 uses all hardware threads
+    explicit ScanPool(size_t threads = 0);
+    ~ScanPool();
+    ScanPool(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    auto threadCount() const noexcept -> size_t;
+
+    // Calls fn(worker, morsel) for every morsel in [0, morsels) and returns when all calls are done.
+    // worker is below threadCount(), morsels has to be below 2^32. Only one thread may call run at a time.
+    template<class Fn>
+    void run(size_t morsels, Fn &&fn) {
+        using Call = std::remove_reference_t<Fn>;
+        auto call = [](void *context, size_t worker, size_t morsel) { (*static_cast<Call *>(context))(worker, morsel); };
+        runJob(morsels, Job{const_cast<void *>(static_cast<const void *>(&fn)), call});
+    }
+
+private:
+    struct Job {
+        void *context{};
+        void (*call)(void *, size_t, size_t){};
+    };
+    struct State;
+
+    void runJob(size_t morsels, Job job);
+
+private:
+    std::unique_ptr<State> state;
+};
+
+} // namespace columnar
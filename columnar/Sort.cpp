@@ -0,0 +1,7 @@
+#include "Sort.h"
+
+namespace columnar {
+
+// TODO
+
+} // namespace columnar
@@ -0,0 +1,126 @@
+#pragma once
+#include "FlagsVector.h"
+
+#include <array>
+#include <cassert>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace columnar {
+
+namespace details {
+
+// Bytes of flags in the order of their numeric value, independent of the byte order of the machine
+template<class F>
+struct SortDigits {
+    using Word = decltype(selectPlaneWord<sizeof(F)>());
+    static constexpr auto wordCount = sizeof(F) / sizeof(Word);
+    static constexpr auto count = (FlagCount<F>::value + 7) / 8;
+
+    static auto words(const F &f) noexcept -> std::array<Word, wordCount> {
+        auto r = std::array<Word, wordCount>{};
+        std::memcpy(r.data(), &f, sizeof(F));
+        return r;
+    }
+    // byte d, byte 0 holds the flags 0 to 7
+    static auto digit(const std::array<Word, wordCount> &w, size_t d) noexcept -> uint8_t {
+        return static_cast<uint8_t>(w[d / sizeof(Word)] >> (d % sizeof(Word) * 8));
+    }
+    static bool equalIn(const F &a, const F &b, const std::array<Word, wordCount> &mask) noexcept {
+        const auto x = words(a);
+        const auto y = words(b);
+        for (auto k = size_t{}; k < wordCount; k++)
+            if (((x[k] ^ y[k]) & mask[k]) != 0) return false;
+        return true;
+    }
+};
+
+// Stable LSD radix sort by the bytes of value & mask, permutation (if not null) moves along
+template<class F>
+void radixSort(std::vector<F> &values, F mask, std::vector<uint32_t> *permutation) {
+    using Digits = SortDigits<F>;
+    const auto n = values.size();
+    const auto maskWords = Digits::words(mask);
+    assert((!permutation || n <= UINT32_MAX) && "permutation entries are 32 bit");
+    if (permutation) {
+        permutation->resize(n);
+        std::iota(permutation->begin(), permutation->end(), uint32_t{});
+    }
+
+    // one counting pass for all digits, digits outside the mask or equal in every value are skipped
+    auto counts = std::vector<std::array<size_t, 256>>(Digits::count);
+    for (const auto &v : values) {
+        const auto w = Digits::words(v);
+        for (auto d = size_t{}; d < Digits::count; d++) counts[d][Digits::digit(w, d) & Digits::digit(maskWords, d)]++;
+    }
+    auto passes = std::vector<size_t>{};
+    for (auto d = size_t{}; d < Digits::count; d++) {
+        if (Digits::digit(maskWords, d) == 0) continue;
+        auto trivial = false;
+        for (auto c : counts[d]) trivial |= c == n;
+        if (!trivial) passes.push_back(d);
+    }
+    if (passes.empty()) return;
+
+    auto otherValues = std::vector<F>(n);
+    auto otherPermutation = std::vector<uint32_t>(permutation ? n : 0);
+    for (auto d : passes) {
+        auto offsets = std::array<size_t, 256>{};
+        auto sum = size_t{};
+        for (auto b = size_t{}; b < 256; b++) offsets[b] = std::exchange(sum, sum + counts[d][b]);
+
+        const auto digitMask = Digits::digit(maskWords, d);
+        for (auto i = size_t{}; i < n; i++) {
+            const auto at = offsets[Digits::digit(Digits::words(values[i]), d) & digitMask]++;
+            otherValues[at] = values[i];
+            if (permutation) otherPermutation[at] = (*permutation)[i];
+        }
+        values.swap(otherValues);
+        if (permutation) permutation->swap(otherPermutation);
+    }
+}
+
+} // namespace details
+
+// Sorts values ascending by the total order of F (operator<) with an LSD radix sort over the bytes that hold flags.
+// permutation receives the original position of every sorted value, apply it to payload columns with reorder().
+// Only bytes that differ between the values cost a pass. Any number of values, with a permutation fewer than 2^32.
+template<class F>
+void radix_sort(std::vector<F> &values, std::vector<uint32_t> *permutation = nullptr) {
+    auto all = std::array<unsigned char, sizeof(F)>{};
+    all.fill(0xff);
+    auto mask = F{};
+    std::memcpy(static_cast<void *>(&mask), all.data(), sizeof(F));
+    details::radixSort(values, mask, permutation);
+}
+
+// Groups values with the same flags of mask, the other flags are ignored and keep their order (stable).
+// Returns the run boundaries: group i is [bounds[i], bounds[i + 1]), the last entry is values.size().
+// Groups are in ascending order of value & mask.
+template<class F>
+auto group_by_mask(std::vector<F> &values, F mask, std::vector<uint32_t> *permutation = nullptr)
+    -> std::vector<size_t> {
+    using Digits = details::SortDigits<F>;
+    details::radixSort(values, mask, permutation);
+    const auto maskWords = Digits::words(mask);
+    auto bounds = std::vector<size_t>{};
+    for (auto i = size_t{}; i < values.size(); i++)
+        if (i == 0 || !Digits::equalIn(values[i], values[i - 1], maskWords)) bounds.push_back(i);
+    bounds.push_back(values.size());
+    return bounds;
+}
+
+// Reorders a payload column like the values of a radix_sort or group_by_mask
+template<class T>
+void reorder(std::vector<T> &column, const std::vector<uint32_t> &permutation) {
+    auto r = std::vector<T>{};
+    r.reserve(permutation.size());
+    for (auto i : permutation) r.push_back(std::move(column[i]));
+    column.swap(r);
+}
+
+} // namespace columnar
@@ -0,0 +1,37 @@
+#include "TextParser.h"
+
+#include "meta/details/Hash.h"
+
+namespace columnar::details {
+
+namespace {
+
+auto hashName(std::string_view s) noexcept -> uint64_t {
+    const auto h = meta::details::fnv1a(s);
+    return h ^ (h >> 32);
+}
+
+} // namespace
+
+NameTable::NameTable(const std::vector<std::string> &names)
+    : names(names) {
+    auto size = size_t{16};
+    while (size < 2 * names.size()) size *= 2;
+    slots.resize(size);
+    for (auto i = size_t{}; i < names.size(); i++) {
+        if (names[i].empty() || find(names[i]) != npos) continue;
+        auto s = hashName(names[i]) & (size - 1);
+        while (slots[s] != 0) s = (s + 1) & (size - 1);
+        slots[s] = static_cast<uint32_t>(i + 1);
+        longest = std::max(longest, names[i].size());
+    }
+}
+
+auto NameTable::find(std::string_view name) const noexcept -> size_t {
+    const auto mask = slots.size() - 1;
+    for (auto s = hashName(name) & mask; slots[s] != 0; s = (s + 1) & mask)
+        if (names[slots[s] - 1] == name) return slots[s] - 1;
+    return npos;
+}
+
+} // namespace columnar::details
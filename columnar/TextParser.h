@@ -0,0 +1,212 @@
+#pragma once
+#include "FlagsVector.h"
+#include "details/TextKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace columnar {
+
+namespace details {
+
+// Flag index by name, open addressing over a power of two table
+struct NameTable {
+    static constexpr auto npos = ~size_t{};
+
+    // names in flag index order, empty names are skipped
+    explicit NameTable(const std::vector<std::string> &names);
+
+    auto find(std::string_view name) const noexcept -> size_t;
+    // length of the longest name
+    auto maxLength() const noexcept -> size_t { return longest; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<uint32_t> slots; // index + 1, 0 for an empty slot
+    size_t longest{};
+};
+
+} // namespace details
+
+// Streaming parser for the text of operator<<, one flags value per line
+//
+//     Cat | Dog
+//     <None>
+//
+// Names are separated by '|', blanks (space, tab, '\r') are ignored, blank lines are skipped.
+// Every 64 bytes are classified at once (AVX2 or SSE2 compares into bit masks), only the token boundaries,
+// separators and newlines are visited one by one. Names are looked up in a hash table, nothing is allocated per line.
+//
+// Input arrives in chunks of any size, lines and names may span chunks:
+//
+//     auto parser = columnar::FlagsTextParser<Animals>{{"Cat", "Dog", "", "Wolf"}};
+//     auto column = columnar::FlagsVector<Animals>{};
+//     while (auto chunk = read(file)) parser.parse(chunk, column);
+//     parser.finish(column);
+//
+// Malformed lines are skipped. errors() reports the first errorLimit of them by stream offset.
+template<class F>
+struct FlagsTextParser {
+    using This = FlagsTextParser;
+    using Vector = FlagsVector<F>;
+    static constexpr auto noneText = std::string_view{"<None>"};
+    static constexpr auto errorLimit = size_t{1024};
+
+    // Offending bytes of a malformed line: an unknown name, a misplaced '|' or <None>,
+    // or the newline (length 0) of a line that ends with '|'.
+    struct Error {
+        uint64_t offset{};
+        uint64_t length{};
+    };
+
+    // names in flag index order, an empty name skips an index
+    explicit FlagsTextParser(const std::vector<std::string> &names)
+        : table(names) {
+        carry.reserve(carryLimit());
+        errorList.reserve(16);
+    }
+
+    // Parses the next chunk of the stream, every complete line is appended to out
+    void parse(std::string_view chunk, Vector &out) {
+        const auto size = chunk.size();
+        for (auto b = size_t{}; b < size; b += details::blockRows) {
+            const auto n = std::min(details::blockRows, size - b);
+            const auto m = details::classifyText(chunk.data() + b, n);
+            const auto before = (m.name << 1) | (inToken ? 1 : 0);
+            const auto starts = m.name & ~before;
+            const auto ends = ~m.name & before & details::blockMask(n);
+            for (auto events = starts | ends | m.separator | m.newline; events != 0; events &= events - 1) {
+                const auto i = details::countTrailingZeros(events);
+                const auto bit = uint64_t{1} << i;
+                const auto at = b + i;
+                if (ends & bit) endToken(chunk, at);
+                if (starts & bit) {
+                    tokenStart = at;
+                    tokenInChunk = true;
+                    tokenOffset = position + at;
+                }
+                if (m.separator & bit) separator(position + at);
+                if (m.newline & bit) newline(position + at, out);
+            }
+            inToken = (m.name >> (n - 1)) & 1;
+        }
+        // keep the start of an unfinished name for the next chunk
+        if (inToken) {
+            appendCarry(chunk.substr(tokenInChunk ? tokenStart : 0));
+            tokenInChunk = false;
+        }
+        position += size;
+    }
+
+    // Ends the stream, a last line without newline is appended to out
+    void finish(Vector &out) {
+        if (inToken) endToken({}, 0);
+        inToken = false;
+        newline(position, out);
+    }
+
+    // bytes parsed so far
+    auto offset() const noexcept -> uint64_t { return position; }
+    auto malformedLines() const noexcept -> uint64_t { return malformed; }
+    auto errors() const noexcept -> const std::vector<Error> & { return errorList; }
+
+private:
+    using Word = typename Vector::Word;
+    static constexpr auto wordBits = Vector::wordBits;
+    using Words = std::array<Word, Vector::planeCount>;
+
+    // an unfinished name longer than every name can not match, so only its length is kept
+    auto carryLimit() const noexcept -> size_t { return std::max(table.maxLength(), noneText.size()) + 1; }
+
+    void appendCarry(std::string_view s) {
+        carryLength += s.size();
+        carry.append(s.substr(0, carryLimit() - std::min(carryLimit(), carry.size())));
+    }
+
+    void endToken(std::string_view chunk, size_t at) {
+        inToken = false;
+        if (tokenInChunk) return token(chunk.substr(tokenStart, at - tokenStart), at - tokenStart);
+        appendCarry(chunk.substr(0, at));
+        token(carry, carryLength);
+        carry.clear();
+        carryLength = 0;
+    }
+
+    void token(std::string_view name, uint64_t length) {
+        if (lineBad) return;
+        if (expectSeparator) return fail(tokenOffset, length);
+        if (name == noneText) {
+            if (separators != 0) return fail(tokenOffset, length);
+            none = true;
+        }
+        else {
+            const auto b = table.find(name);
+            if (b == details::NameTable::npos || b >= Vector::flagCount) return fail(tokenOffset, length);
+            value[b / wordBits] |= static_cast<Word>(Word{1} << (b % wordBits));
+        }
+        tokens++;
+        expectSeparator = true;
+    }
+
+    void separator(uint64_t at) {
+        if (lineBad) return;
+        if (!expectSeparator || none) return fail(at, 1);
+        separators++;
+        expectSeparator = false;
+    }
+
+    void newline(uint64_t at, Vector &out) {
+        if (!lineBad && tokens + separators != 0) {
+            if (!expectSeparator)
+                fail(at, 0);
+            else {
+                auto f = F{};
+                std::memcpy(static_cast<void *>(&f), value.data(), sizeof(F));
+                out.push_back(f);
+            }
+        }
+        if (lineBad) {
+            malformed++;
+            if (errorList.size() < errorLimit) errorList.push_back(lineError);
+        }
+        value = Words{};
+        tokens = separators = 0;
+        expectSeparator = none = lineBad = false;
+    }
+
+    void fail(uint64_t at, uint64_t length) {
+        lineBad = true;
+        lineError = {at, length};
+    }
+
+private:
+    details::NameTable table;
+    std::vector<Error> errorList;
+    uint64_t malformed{};
+    uint64_t position{}; // stream offset of the current chunk
+
+    // current name
+    bool inToken{};
+    bool tokenInChunk{};
+    size_t tokenStart{};
+    uint64_t tokenOffset{};
+    std::string carry;
+    uint64_t carryLength{};
+
+    // current line
+    Words value{};
+    uint32_t tokens{};
+    uint32_t separators{};
+    bool expectSeparator{};
+    bool none{};
+    bool lineBad{};
+    Error lineError{};
+};
+
+} // namespace columnar
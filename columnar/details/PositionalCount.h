@@ -0,0 +1,159 @@
+#pragma once
+#include "ScanKernels.h"
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+
+namespace columnar::details {
+
+// Vertical popcount: number of words with bit p set, for all 64 bit positions p of a stream of uint64_t words
+//
+// Every position has a bit-sliced binary counter, level[l] holds bit l of all 64 (or 256 with AVX2) counters.
+// Harley-Seal carry-save adders fold 16 vectors into the four lowest levels and carry one "sixteens" vector,
+// which ripples into the upper levels. The counters are moved to plain integers before they could overflow.
+// A word costs about one CSA (5 logic operations) regardless of how many bits it has set.
+struct PositionalCount {
+    using Counts = std::array<uint64_t, 64>;
+
+    // data holds words uint64_t values, it does not have to be aligned
+    void add(const void *data, size_t words) noexcept {
+        auto p = static_cast<const unsigned char *>(data);
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+        constexpr auto block = size_t{16 * 4};
+        for (; words >= block; words -= block, p += block * 8) {
+            if (wide.pending + 16 > Counter<Avx2>::limit) wide.flush(counts);
+            wide.add16(p);
+        }
+#endif
+        constexpr auto scalarBlock = size_t{16};
+        for (; words >= scalarBlock; words -= scalarBlock, p += scalarBlock * 8) {
+            if (narrow.pending + 16 > Counter<Scalar>::limit) narrow.flush(counts);
+            narrow.add16(p);
+        }
+        for (; words > 0; words--, p += 8) {
+            if (narrow.pending + 1 > Counter<Scalar>::limit) narrow.flush(counts);
+            narrow.add1(p);
+        }
+    }
+
+    // words with bit p set at [p]
+    auto result() noexcept -> const Counts & {
+        narrow.flush(counts);
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+        wide.flush(counts);
+#endif
+        return counts;
+    }
+
+private:
+    static auto bitAnd(uint64_t a, uint64_t b) noexcept { return a & b; }
+    static auto bitOr(uint64_t a, uint64_t b) noexcept { return a | b; }
+    static auto bitXor(uint64_t a, uint64_t b) noexcept { return a ^ b; }
+    static bool isZero(uint64_t a) noexcept { return a == 0; }
+    static void load(uint64_t &v, const unsigned char *p) noexcept { std::memcpy(&v, p, sizeof(v)); }
+    static void store(uint64_t *out, uint64_t v) noexcept { out[0] = v; }
+
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+    static auto bitAnd(__m256i a, __m256i b) noexcept { return _mm256_and_si256(a, b); }
+    static auto bitOr(__m256i a, __m256i b) noexcept { return _mm256_or_si256(a, b); }
+    static auto bitXor(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(a, b); }
+    static bool isZero(__m256i a) noexcept { return _mm256_testz_si256(a, a) != 0; }
+    static void load(__m256i &v, const unsigned char *p) noexcept {
+        v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static void store(uint64_t *out, __m256i v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v); }
+#endif
+
+    // vector types carry attributes that template arguments drop, so counters are selected by a tag
+    struct Scalar {
+        using V = uint64_t;
+    };
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+    struct Avx2 {
+        using V = __m256i;
+    };
+#endif
+
+    template<class Lanes>
+    struct Counter {
+        using V = typename Lanes::V;
+        static constexpr auto levels = size_t{16};
+        static constexpr auto limit = (size_t{1} << levels) - 1;
+        static constexpr auto lanes = sizeof(V) / sizeof(uint64_t);
+
+        V level[levels]{};
+        size_t pending{}; // largest possible value of any counter
+
+        // carry save adder: h:l = a + b + c
+        static void csa(V &h, V &l, V a, V b, V c) noexcept {
+            const auto u = bitXor(a, b);
+            h = bitOr(bitAnd(a, b), bitAnd(u, c));
+            l = bitXor(u, c);
+        }
+
+        void ripple(V carry, size_t l) noexcept {
+            for (; l < levels && !isZero(carry); l++) {
+                const auto t = bitAnd(level[l], carry);
+                level[l] = bitXor(level[l], carry);
+                carry = t;
+            }
+        }
+
+        void add1(const unsigned char *p) noexcept {
+            auto v = V{};
+            load(v, p);
+            ripple(v, 0);
+            pending++;
+        }
+
+        // 16 vectors, level 0 to 3 are the ones, twos, fours and eights of Harley-Seal
+        void add16(const unsigned char *p) noexcept {
+            V v[16];
+            for (auto i = 0; i < 16; i++) load(v[i], p + i * sizeof(V));
+            auto &ones = level[0];
+            auto &twos = level[1];
+            auto &fours = level[2];
+            auto &eights = level[3];
+            V twosA, twosB, foursA, foursB, eightsA, eightsB, sixteens;
+            csa(twosA, ones, ones, v[0], v[1]);
+            csa(twosB, ones, ones, v[2], v[3]);
+            csa(foursA, twos, twos, twosA, twosB);
+            csa(twosA, ones, ones, v[4], v[5]);
+            csa(twosB, ones, ones, v[6], v[7]);
+            csa(foursB, twos, twos, twosA, twosB);
+            csa(eightsA, fours, fours, foursA, foursB);
+            csa(twosA, ones, ones, v[8], v[9]);
+            csa(twosB, ones, ones, v[10], v[11]);
+            csa(foursA, twos, twos, twosA, twosB);
+            csa(twosA, ones, ones, v[12], v[13]);
+            csa(twosB, ones, ones, v[14], v[15]);
+            csa(foursB, twos, twos, twosA, twosB);
+            csa(eightsB, fours, fours, foursA, foursB);
+            csa(sixteens, eights, eights, eightsA, eightsB);
+            ripple(sixteens, 4);
+            pending += 16;
+        }
+
+        void flush(Counts &counts) noexcept {
+            for (auto l = size_t{}; l < levels; l++) {
+                uint64_t w[lanes];
+                store(w, level[l]);
+                level[l] = V{};
+                for (auto lane : w)
+                    for (; lane != 0; lane &= lane - 1) counts[countTrailingZeros(lane)] += uint64_t{1} << l;
+            }
+            pending = 0;
+        }
+    };
+
+private:
+    Counts counts{};
+    Counter<Scalar> narrow{};
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+    Counter<Avx2> wide{};
+#endif
+};
+
+} // namespace columnar::details
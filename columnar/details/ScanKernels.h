@@ -0,0 +1,199 @@
+#pragma once
+#include "meta/details/TrailingZeros.h"
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLUMNAR_HAS_AVX2_SCAN 1
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace columnar::details {
+
+// number of rows every scan kernel handles at once, one bit per row
+constexpr auto blockRows = size_t{64};
+
+inline auto countSetBits(uint64_t v) noexcept -> size_t {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(v));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<size_t>(__popcnt64(v));
+#else
+    v = v - ((v >> 1) & 0x5555555555555555);
+    v = (v & 0x3333333333333333) + ((v >> 2) & 0x3333333333333333);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0f;
+    return static_cast<size_t>((v * 0x0101010101010101) >> 56);
+#endif
+}
+
+using meta::details::countTrailingZeros;
+
+// Bits set for the first n rows of a block
+constexpr auto blockMask(size_t n) noexcept -> uint64_t {
+    return n >= blockRows ? ~uint64_t{} : (uint64_t{1} << n) - 1;
+}
+
+// Row predicate of all scans: (v & include) == include && (v & exclude) == 0 in every plane
+// all(mask) = {mask, 0}, none(mask) = {0, mask}, any(mask) = !none(mask)
+template<class Word, size_t Planes>
+struct Predicate {
+    std::array<Word, Planes> include{};
+    std::array<Word, Planes> exclude{};
+};
+
+template<class Word, size_t Planes>
+using Columns = std::array<const Word *, Planes>;
+
+// Returns one bit per row for the 64 rows starting at row.
+// Every plane has to be readable for the whole block.
+template<class Word, size_t Planes>
+auto matchBlockScalar(const Columns<Word, Planes> &planes, const Predicate<Word, Planes> &p, size_t row) noexcept
+    -> uint64_t {
+    auto r = uint64_t{};
+    for (auto i = size_t{}; i < blockRows; i++) {
+        auto ok = true;
+        for (auto k = size_t{}; k < Planes; k++) {
+            const auto v = planes[k][row + i];
+            ok &= (v & p.include[k]) == p.include[k] && (v & p.exclude[k]) == Word{};
+        }
+        r |= uint64_t{ok} << i;
+    }
+    return r;
+}
+
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+
+template<class Word>
+inline auto broadcast(Word w) noexcept -> __m256i {
+    if constexpr (sizeof(Word) == 1) return _mm256_set1_epi8(static_cast<char>(w));
+    if constexpr (sizeof(Word) == 2) return _mm256_set1_epi16(static_cast<short>(w));
+    if constexpr (sizeof(Word) == 4) return _mm256_set1_epi32(static_cast<int>(w));
+    if constexpr (sizeof(Word) == 8) return _mm256_set1_epi64x(static_cast<long long>(w));
+}
+
+template<class Word>
+inline auto lanesEqual(__m256i a, __m256i b) noexcept -> __m256i {
+    if constexpr (sizeof(Word) == 1) return _mm256_cmpeq_epi8(a, b);
+    if constexpr (sizeof(Word) == 2) return _mm256_cmpeq_epi16(a, b);
+    if constexpr (sizeof(Word) == 4) return _mm256_cmpeq_epi32(a, b);
+    if constexpr (sizeof(Word) == 8) return _mm256_cmpeq_epi64(a, b);
+}
+
+// AVX2 version of matchBlockScalar
+// Lanes of all planes are combined first, then the lane masks are compressed to one bit per row.
+template<class Word, size_t Planes>
+auto matchBlock(const Columns<Word, Planes> &planes, const Predicate<Word, Planes> &p, size_t row) noexcept
+    -> uint64_t {
+    constexpr auto lanes = sizeof(__m256i) / sizeof(Word);
+    constexpr auto vectors = blockRows / lanes;
+
+    __m256i ok[vectors];
+    for (auto j = size_t{}; j < vectors; j++) ok[j] = _mm256_set1_epi8(-1);
+    for (auto k = size_t{}; k < Planes; k++) {
+        const auto include = broadcast(p.include[k]);
+        const auto exclude = broadcast(p.exclude[k]);
+        for (auto j = size_t{}; j < vectors; j++) {
+            const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(planes[k] + row + j * lanes));
+            const auto hasAll = lanesEqual<Word>(_mm256_and_si256(v, include), include);
+            const auto hasNone = lanesEqual<Word>(_mm256_and_si256(v, exclude), _mm256_setzero_si256());
+            ok[j] = _mm256_and_si256(ok[j], _mm256_and_si256(hasAll, hasNone));
+        }
+    }
+
+    auto r = uint64_t{};
+    if constexpr (sizeof(Word) == 2) {
+        // packs interleaves 128 bit halves, the permute restores row order
+        for (auto j = size_t{}; j < vectors; j += 2) {
+            const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(ok[j], ok[j + 1]), 0xd8);
+            r |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(packed))} << (j * lanes);
+        }
+    }
+    else {
+        for (auto j = size_t{}; j < vectors; j++) {
+            auto bits = 0;
+            if constexpr (sizeof(Word) == 1) bits = _mm256_movemask_epi8(ok[j]);
+            if constexpr (sizeof(Word) == 4) bits = _mm256_movemask_ps(_mm256_castsi256_ps(ok[j]));
+            if constexpr (sizeof(Word) == 8) bits = _mm256_movemask_pd(_mm256_castsi256_pd(ok[j]));
+            r |= uint64_t{static_cast<uint32_t>(bits)} << (j * lanes);
+        }
+    }
+    return r;
+}
+
+#else
+
+template<class Word, size_t Planes>
+auto matchBlock(const Columns<Word, Planes> &planes, const Predicate<Word, Planes> &p, size_t row) noexcept
+    -> uint64_t {
+    return matchBlockScalar(planes, p, row);
+}
+
+#endif // COLUMNAR_HAS_AVX2_SCAN
+
+// Per query lookup table for byte codes: code c matches if bit c of bits is set
+// lo/hi hold the same bits rearranged for 16 entry byte shuffles:
+// bit h of lo[c & 15] is code (h << 4) | (c & 15) for h < 8, hi covers h >= 8.
+struct ByteLookup {
+    std::array<uint64_t, 4> bits{};
+    std::array<uint8_t, 16> lo{};
+    std::array<uint8_t, 16> hi{};
+
+    void add(uint8_t c) noexcept {
+        bits[c / 64] |= uint64_t{1} << (c % 64);
+        auto &t = c < 128 ? lo : hi;
+        t[c & 15] = static_cast<uint8_t>(t[c & 15] | (1 << ((c >> 4) & 7)));
+    }
+};
+
+inline auto lookupBlockScalar(const uint8_t *codes, const ByteLookup &t, size_t row) noexcept -> uint64_t {
+    auto r = uint64_t{};
+    for (auto i = size_t{}; i < blockRows; i++) {
+        const auto c = codes[row + i];
+        r |= ((t.bits[c / 64] >> (c % 64)) & 1) << i;
+    }
+    return r;
+}
+
+// Returns one bit per row for the 64 byte codes starting at row.
+#ifdef COLUMNAR_HAS_AVX2_SCAN
+inline auto lookupBlock(const uint8_t *codes, const ByteLookup &t, size_t row) noexcept -> uint64_t {
+    const auto lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(t.lo.data())));
+    const auto hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(t.hi.data())));
+    const auto bitOf = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, //
+                                        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const auto nibble = _mm256_set1_epi8(0x0f);
+
+    auto r = uint64_t{};
+    for (auto j = size_t{}; j < blockRows; j += 32) {
+        const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + row + j));
+        const auto l = _mm256_and_si256(c, nibble);
+        const auto h = _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble);
+        const auto upper = _mm256_cmpgt_epi8(h, _mm256_set1_epi8(7));
+        const auto bits = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, l), _mm256_shuffle_epi8(hi, l), upper);
+        const auto bit = _mm256_shuffle_epi8(bitOf, h);
+        const auto hit = _mm256_cmpeq_epi8(_mm256_and_si256(bits, bit), bit);
+        r |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(hit))} << j;
+    }
+    return r;
+}
+#else
+inline auto lookupBlock(const uint8_t *codes, const ByteLookup &t, size_t row) noexcept -> uint64_t {
+    return lookupBlockScalar(codes, t, row);
+}
+#endif
+
+// Returns one bit per row for the 64 short codes starting at row, bits holds one bit per code.
+inline auto lookupBlock(const uint16_t *codes, const uint64_t *bits, size_t row) noexcept -> uint64_t {
+    auto r = uint64_t{};
+    for (auto i = size_t{}; i < blockRows; i++) {
+        const auto c = codes[row + i];
+        r |= ((bits[c / 64] >> (c % 64)) & 1) << i;
+    }
+    return r;
+}
+
+} // namespace columnar::details
@@ -0,0 +1,72 @@
+#pragma once
+#include "ScanKernels.h"
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+
+#if !defined(COLUMNAR_HAS_AVX2_SCAN) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define COLUMNAR_HAS_SSE2_TEXT 1
+#endif
+
+namespace columnar::details {
+
+// Byte classes of 64 bytes of flags text, bit i describes byte i
+// Bytes that are neither separator, blank nor newline belong to a name.
+struct TextMasks {
+    uint64_t name{};
+    uint64_t separator{}; // '|'
+    uint64_t newline{};   // '\n'
+};
+
+// Classifies up to 64 bytes, the bits past n are zero in every mask
+inline auto classifyText(const char *p, size_t n) noexcept -> TextMasks {
+    alignas(32) char block[blockRows];
+    if (n < blockRows) {
+        std::memset(block, ' ', sizeof(block));
+        std::memcpy(block, p, n);
+        p = block;
+    }
+    auto r = TextMasks{};
+    auto blank = uint64_t{};
+#if defined(COLUMNAR_HAS_AVX2_SCAN)
+    for (auto i = 0; i < 2; i++) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * i));
+        const auto is = [&](char c) {
+            const auto m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+            return uint64_t{static_cast<uint32_t>(m)} << (32 * i);
+        };
+        r.separator |= is('|');
+        r.newline |= is('\n');
+        blank |= is(' ') | is('\t') | is('\r');
+    }
+#elif defined(COLUMNAR_HAS_SSE2_TEXT)
+    for (auto i = 0; i < 4; i++) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+        const auto is = [&](char c) {
+            const auto m = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+            return uint64_t{static_cast<uint16_t>(m)} << (16 * i);
+        };
+        r.separator |= is('|');
+        r.newline |= is('\n');
+        blank |= is(' ') | is('\t') | is('\r');
+    }
+#else
+    for (auto i = size_t{}; i < blockRows; i++) {
+        const auto bit = uint64_t{1} << i;
+        switch (p[i]) {
+        case '|': r.separator |= bit; break;
+        case '\n': r.newline |= bit; break;
+        case ' ':
+        case '\t':
+        case '\r': blank |= bit; break;
+        default: break;
+        }
+    }
+#endif
+    r.name = ~(r.separator | r.newline | blank) & blockMask(n);
+    return r;
+}
+
+} // namespace columnar::details
@@ -0,0 +1,7 @@
+#include "AsyncFlags.h"
+
+namespace concurrent {
+
+// TODO
+
+} // namespace concurrent
@@ -0,0 +1,204 @@
+#pragma once
+#include "AtomicFlags.h"
+#include "details/Coroutine.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+namespace concurrent {
+
+// Resumes the coroutine on the thread that changed the flags
+struct InlineExecutor {
+    template<class Handle>
+    void operator()(Handle h) const {
+        h.resume();
+    }
+};
+
+// Shared flags with coroutine awaitables
+//
+//     auto r = co_await flags.when_all(Animal::Cat | Animal::Dog, executor);
+//
+// A set/reset/flip/store resumes all coroutines whose condition now holds on the caller supplied executor.
+// The executor is any callable taking the coroutine handle (e.g. posting it to a thread pool).
+// Waiters live inside the awaitables (coroutine frames), so awaiting never allocates.
+// Destroying a coroutine suspended in an await removes its waiter.
+// Changes without waiters cost one atomic operation and one load.
+template<class F>
+struct AsyncFlags {
+    using This = AsyncFlags;
+    using Flags = F;
+    using Atomic = AtomicFlags<F>;
+    using Word = typename Atomic::Word;
+    using Handle = details::coro::coroutine_handle<>;
+
+private:
+    enum class Kind { All, Any, Changed };
+
+    struct Waiter {
+        Waiter *next{};
+        Kind kind{};
+        Word mask{};
+        Word seen{};
+        bool queued{}; // guarded by mutex
+        void (*post)(Waiter *){};
+    };
+
+public:
+    template<class Executor>
+    struct Awaitable : private Waiter {
+        Awaitable(This &flags, Kind kind, Word mask, Executor executor)
+            : flags(flags)
+            , executor(std::move(executor)) {
+            this->kind = kind;
+            this->mask = mask;
+        }
+        ~Awaitable() {
+            if (handle) flags.dequeue(*this);
+        }
+
+        bool await_ready() noexcept {
+            this->seen = Atomic::toWord(flags.flags.load());
+            return this->kind != Kind::Changed && isReady(*this, this->seen);
+        }
+        bool await_suspend(Handle h) noexcept {
+            handle = h;
+            this->post = [](Waiter *w) {
+                auto a = static_cast<Awaitable *>(w);
+                a->executor(a->handle);
+            };
+            return flags.enqueue(*this);
+        }
+        // returns the flags that satisfied the condition
+        auto await_resume() const noexcept -> F { return Atomic::toFlags(this->seen); }
+
+    private:
+        friend struct AsyncFlags;
+        This &flags;
+        Executor executor;
+        Handle handle{};
+    };
+
+    constexpr AsyncFlags() noexcept = default;
+    AsyncFlags(F f) noexcept
+        : flags(f) {}
+    AsyncFlags(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    auto load(std::memory_order order = std::memory_order_seq_cst) const noexcept -> F { return flags.load(order); }
+
+    bool operator[](F f) const noexcept { return flags[f]; }
+    bool any(F f) const noexcept { return flags.any(f); }
+    bool all(F f) const noexcept { return flags.all(f); }
+    bool none(F f) const noexcept { return flags.none(f); }
+    bool none() const noexcept { return flags.none(); }
+
+    // modifications return the previous flags and resume the satisfied waiters
+    auto store(F f) -> F { return notify(flags.exchange(f)); }
+    auto set(F f) -> F { return notify(flags.set(f)); }
+    auto reset(F f) -> F { return notify(flags.reset(f)); }
+    auto flip(F f) -> F { return notify(flags.flip(f)); }
+
+    // completes when all bits of mask are set
+    template<class Executor = InlineExecutor>
+    auto when_all(F mask, Executor executor = {}) noexcept -> Awaitable<Executor> {
+        return {*this, Kind::All, Atomic::toWord(mask), std::move(executor)};
+    }
+
+    // completes when any bit of mask is set
+    template<class Executor = InlineExecutor>
+    auto when_any(F mask, Executor executor = {}) noexcept -> Awaitable<Executor> {
+        return {*this, Kind::Any, Atomic::toWord(mask), std::move(executor)};
+    }
+
+    // completes on the next change of any bit in mask
+    template<class Executor = InlineExecutor>
+    auto when_changed(F mask, Executor executor = {}) noexcept -> Awaitable<Executor> {
+        return {*this, Kind::Changed, Atomic::toWord(mask), std::move(executor)};
+    }
+    template<class Executor = InlineExecutor>
+    auto when_changed(Executor executor = {}) noexcept -> Awaitable<Executor> {
+        return {*this, Kind::Changed, static_cast<Word>(~Word{}), std::move(executor)};
+    }
+
+private:
+    static bool isReady(const Waiter &w, Word v) noexcept {
+        switch (w.kind) {
+        case Kind::All: return (v & w.mask) == w.mask;
+        case Kind::Any: return (v & w.mask) != Word{};
+        case Kind::Changed: return ((v ^ w.seen) & w.mask) != Word{};
+        }
+        return false;
+    }
+
+    // returns false if the condition already holds and the coroutine continues
+    bool enqueue(Waiter &w) {
+        auto lock = std::lock_guard<std::mutex>{mutex};
+        // announce before the check, so a concurrent change cannot skip the notification
+        waiting.fetch_add(1);
+        const auto v = Atomic::toWord(flags.load());
+        if (isReady(w, v)) {
+            waiting.fetch_sub(1);
+            w.seen = v;
+            return false;
+        }
+        w.next = head;
+        w.queued = true;
+        head = &w;
+        return true;
+    }
+
+    // unlinks a waiter that was not resumed
+    void dequeue(Waiter &w) {
+        auto lock = std::lock_guard<std::mutex>{mutex};
+        if (!w.queued) return;
+        for (auto p = &head; *p != nullptr; p = &(*p)->next) {
+            if (*p == &w) {
+                *p = w.next;
+                break;
+            }
+        }
+        w.queued = false;
+        waiting.fetch_sub(1);
+    }
+
+    auto notify(F prev) -> F {
+        if (waiting.load() == 0) return prev;
+
+        auto ready = static_cast<Waiter *>(nullptr);
+        {
+            auto lock = std::lock_guard<std::mutex>{mutex};
+            const auto v = Atomic::toWord(flags.load());
+            for (auto p = &head; *p != nullptr;) {
+                auto w = *p;
+                if (isReady(*w, v)) {
+                    *p = w->next;
+                    w->queued = false;
+                    w->seen = v;
+                    w->next = ready;
+                    ready = w;
+                    waiting.fetch_sub(1);
+                }
+                else {
+                    p = &w->next;
+                }
+            }
+        }
+        // resuming may destroy the waiter
+        while (ready != nullptr) {
+            auto w = ready;
+            ready = w->next;
+            w->post(w);
+        }
+        return prev;
+    }
+
+private:
+    Atomic flags{};
+    std::atomic<uint32_t> waiting{};
+    std::mutex mutex{};
+    Waiter *head{};
+};
+
+} // namespace concurrent
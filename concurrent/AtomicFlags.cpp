@@ -0,0 +1,7 @@
+#include "AtomicFlags.h"
+
+namespace concurrent {
+
+// TODO
+
+} // namespace concurrent
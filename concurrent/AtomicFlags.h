@@ -0,0 +1,125 @@
+#pragma once
+#include "details/DoubleWord.h"
+#include "meta/details/BitStorage.h"
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace concurrent {
+
+namespace details {
+
+template<size_t bytes>
+constexpr auto selectAtomicWord() {
+    if constexpr (bytes <= sizeof(uint64_t))
+        return meta::details::SelectBitWord<bytes * 8>();
+    else
+        return DoubleWord{};
+}
+
+template<class Word>
+using AtomicWord = std::conditional_t<std::is_same_v<Word, DoubleWord>, AtomicDoubleWord, std::atomic<Word>>;
+
+} // namespace details
+
+// Lock-free wrapper around any flags type up to 128 bits
+// F is one of classic::Flags, bitnumber::Flags, tagtype::Flags, tagvalue::Flags or repeated::Flags
+//
+// The flags are stored as an unsigned word of the same size.
+// set/reset/flip/mask map to fetch_or/fetch_and/fetch_xor and return the previous flags.
+// 128 bit flags use a cmpxchg16b loop with backoff (see details::AtomicDoubleWord).
+// Even their loads write, so they can not live in read-only memory (const globals in .rodata, read-only mappings).
+template<class F>
+struct AtomicFlags {
+    using This = AtomicFlags;
+    using Flags = F;
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+    static_assert(sizeof(F) <= 2 * sizeof(uint64_t), "AtomicFlags supports up to 128 bits");
+
+    using Word = decltype(details::selectAtomicWord<sizeof(F)>());
+    static_assert(sizeof(Word) == sizeof(F), "flags have to be the size of a word");
+    static constexpr bool isAlwaysLockFree = details::AtomicWord<Word>::is_always_lock_free;
+    static_assert(sizeof(F) <= sizeof(uint64_t) || isAlwaysLockFree,
+                  "128 bit AtomicFlags require cmpxchg16b (compile with -mcx16)");
+
+    constexpr AtomicFlags() noexcept = default;
+    AtomicFlags(F f) noexcept
+        : w(toWord(f)) {}
+    AtomicFlags(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    bool is_lock_free() const noexcept { return w.is_lock_free(); }
+
+    auto load(std::memory_order order = std::memory_order_seq_cst) const noexcept -> F {
+        return toFlags(w.load(order));
+    }
+    void store(F f, std::memory_order order = std::memory_order_seq_cst) noexcept { w.store(toWord(f), order); }
+    auto exchange(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        return toFlags(w.exchange(toWord(f), order));
+    }
+
+    operator F() const noexcept { return load(); }
+
+    bool operator[](F f) const noexcept { return any(f); }
+
+    bool any(F f, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        return (w.load(order) & toWord(f)) != Word{};
+    }
+    bool all(F f, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        const auto b = toWord(f);
+        return (w.load(order) & b) == b;
+    }
+    bool none(F f, std::memory_order order = std::memory_order_seq_cst) const noexcept { return !any(f, order); }
+    bool none(std::memory_order order = std::memory_order_seq_cst) const noexcept { return w.load(order) == Word{}; }
+
+    auto set(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        return toFlags(w.fetch_or(toWord(f), order));
+    }
+    auto reset(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        return toFlags(w.fetch_and(static_cast<Word>(~toWord(f)), order));
+    }
+    auto flip(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        return toFlags(w.fetch_xor(toWord(f), order));
+    }
+    auto mask(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        return toFlags(w.fetch_and(toWord(f), order));
+    }
+
+    // sets f and returns which of the bits in f were set before
+    auto test_and_set(F f, std::memory_order order = std::memory_order_seq_cst) noexcept -> F {
+        const auto b = toWord(f);
+        return toFlags(static_cast<Word>(w.fetch_or(b, order) & b));
+    }
+
+    // stores desired if the current value equals expected
+    // returns the previous flags, the exchange succeeded if they equal expected
+    auto compare_exchange(F expected,
+                          F desired,
+                          std::memory_order success = std::memory_order_seq_cst,
+                          std::memory_order failure = std::memory_order_seq_cst) noexcept -> F {
+        auto e = toWord(expected);
+        w.compare_exchange_strong(e, toWord(desired), success, failure);
+        return toFlags(e);
+    }
+
+    auto operator|=(F f) noexcept -> F { return toFlags(static_cast<Word>(w.fetch_or(toWord(f)) | toWord(f))); }
+    auto operator&=(F f) noexcept -> F { return toFlags(static_cast<Word>(w.fetch_and(toWord(f)) & toWord(f))); }
+    auto operator^=(F f) noexcept -> F { return toFlags(static_cast<Word>(w.fetch_xor(toWord(f)) ^ toWord(f))); }
+
+    static auto toWord(F f) noexcept -> Word {
+        auto r = Word{};
+        std::memcpy(static_cast<void *>(&r), &f, sizeof(F));
+        return r;
+    }
+    static auto toFlags(Word v) noexcept -> F {
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), &v, sizeof(F));
+        return r;
+    }
+
+private:
+    details::AtomicWord<Word> w{};
+};
+
+} // namespace concurrent
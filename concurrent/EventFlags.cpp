@@ -0,0 +1,7 @@
+#include "EventFlags.h"
+
+namespace concurrent {
+
+// TODO
+
+} // namespace concurrent
@@ -0,0 +1,148 @@
+#pragma once
+#include "AtomicFlags.h"
+#include "details/Futex.h"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace concurrent {
+
+// Event group on top of AtomicFlags
+// Threads block until all/any bits of a mask are set or until they are cleared.
+//
+// Every change bumps a 32 bit sequence word that waiters sleep on with a futex bitset.
+// The bitset is folded from the waiter's mask, so a change only wakes waiters whose mask intersects it.
+// Writers skip the syscall entirely while nobody waits.
+// With Scope::Shared the object may live in memory shared between processes (see FlagBoard).
+template<class F, details::Futex::Scope scope = details::Futex::Scope::Private>
+struct EventFlags {
+    using This = EventFlags;
+    using Flags = F;
+    using Atomic = AtomicFlags<F>;
+    using Word = typename Atomic::Word;
+    using Clock = details::Futex::Clock;
+    static_assert(sizeof(Word) <= sizeof(uint64_t), "EventFlags supports up to 64 bits");
+
+    enum class AutoClear { No, Yes };
+
+    constexpr EventFlags() noexcept = default;
+    EventFlags(F f) noexcept
+        : flags(f) {}
+    EventFlags(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    auto load(std::memory_order order = std::memory_order_seq_cst) const noexcept -> F { return flags.load(order); }
+
+    bool operator[](F f) const noexcept { return flags[f]; }
+    bool any(F f) const noexcept { return flags.any(f); }
+    bool all(F f) const noexcept { return flags.all(f); }
+    bool none(F f) const noexcept { return flags.none(f); }
+    bool none() const noexcept { return flags.none(); }
+
+    // modifications return the previous flags and wake the affected waiters
+    auto store(F f) noexcept -> F {
+        const auto prev = flags.exchange(f);
+        notify(toWord(prev) ^ toWord(f));
+        return prev;
+    }
+    auto set(F f) noexcept -> F {
+        const auto prev = flags.set(f);
+        notify(toWord(f) & ~toWord(prev));
+        return prev;
+    }
+    auto reset(F f) noexcept -> F {
+        const auto prev = flags.reset(f);
+        notify(toWord(f) & toWord(prev));
+        return prev;
+    }
+    auto flip(F f) noexcept -> F {
+        const auto prev = flags.flip(f);
+        notify(toWord(f));
+        return prev;
+    }
+
+    // Waits until all bits of mask are set.
+    // Returns the flags that satisfied the wait or nullopt on timeout.
+    // With AutoClear::Yes the mask bits are cleared in the same atomic step.
+    auto wait_all(F mask, AutoClear clear = AutoClear::No, Clock::duration timeout = Clock::duration::max()) noexcept
+        -> std::optional<F> {
+        const auto m = toWord(mask);
+        return waitFor(
+            m,
+            [m](Word v) { return (v & m) == m; },
+            [m, clear](Word) { return clear == AutoClear::Yes ? m : Word{}; },
+            timeout);
+    }
+
+    // Waits until any bit of mask is set.
+    // With AutoClear::Yes only the bits that were found set are cleared.
+    auto wait_any(F mask, AutoClear clear = AutoClear::No, Clock::duration timeout = Clock::duration::max()) noexcept
+        -> std::optional<F> {
+        const auto m = toWord(mask);
+        return waitFor(
+            m,
+            [m](Word v) { return (v & m) != Word{}; },
+            [m, clear](Word v) { return clear == AutoClear::Yes ? static_cast<Word>(v & m) : Word{}; },
+            timeout);
+    }
+
+    // Waits until all bits of mask are cleared.
+    auto wait_until_cleared(F mask, Clock::duration timeout = Clock::duration::max()) noexcept -> std::optional<F> {
+        const auto m = toWord(mask);
+        return waitFor(
+            m, [m](Word v) { return (v & m) == Word{}; }, [](Word) { return Word{}; }, timeout);
+    }
+
+private:
+    static auto toWord(F f) noexcept -> Word { return Atomic::toWord(f); }
+    static auto toFlags(Word v) noexcept -> F { return Atomic::toFlags(v); }
+
+    void notify(Word changed) noexcept {
+        if (changed == Word{}) return;
+        sequence.fetch_add(1);
+        if (waiters.load() != 0) details::Futex::wake(sequence, details::Futex::bitset(changed), scope);
+    }
+
+    template<class Ready, class Consume>
+    auto tryConsume(Ready &&ready, Consume &&consume) noexcept -> std::optional<F> {
+        auto v = toWord(flags.load());
+        while (ready(v)) {
+            const auto c = consume(v);
+            if (c == Word{}) return toFlags(v);
+            const auto prev = toWord(flags.compare_exchange(toFlags(v), toFlags(static_cast<Word>(v & ~c))));
+            if (prev == v) {
+                notify(c);
+                return toFlags(v);
+            }
+            v = prev;
+        }
+        return std::nullopt;
+    }
+
+    template<class Ready, class Consume>
+    auto waitFor(Word mask, Ready &&ready, Consume &&consume, Clock::duration timeout) noexcept -> std::optional<F> {
+        const auto now = Clock::now();
+        const auto deadline =
+            timeout >= Clock::time_point::max() - now ? Clock::time_point::max() : now + timeout;
+        const auto bitset = details::Futex::bitset(mask);
+
+        waiters.fetch_add(1);
+        auto result = std::optional<F>{};
+        while (true) {
+            const auto s = sequence.load();
+            result = tryConsume(ready, consume);
+            if (result || !details::Futex::wait(sequence, s, bitset, deadline, scope)) break;
+        }
+        if (!result) result = tryConsume(ready, consume);
+        waiters.fetch_sub(1);
+        return result;
+    }
+
+private:
+    Atomic flags{};
+    std::atomic<uint32_t> sequence{};
+    std::atomic<uint32_t> waiters{};
+};
+
+} // namespace concurrent
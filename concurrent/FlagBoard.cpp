@@ -0,0 +1,166 @@
+#include "FlagBoard.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#define CONCURRENT_HAS_FLAG_BOARD 1
+#endif
+
+namespace concurrent {
+
+using details::BoardSlot;
+
+namespace {
+
+// waits about a second for a board or entry under construction by another process
+template<class Ready>
+bool waitFor(Ready &&ready) {
+    for (auto i = 0; i < 1000; i++) {
+        if (ready()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return ready();
+}
+
+} // namespace
+
+struct alignas(64) FlagBoard::Header {
+    static constexpr auto magicValue = uint64_t{0x314452414f42474c}; // "LGBOARD1"
+    static constexpr auto versionValue = uint32_t{1};
+    static constexpr auto layoutValue = uint32_t{sizeof(BoardSlot) << 8 | alignof(BoardSlot)};
+
+    // written last by the creator, readers wait for it
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t layout;
+    uint32_t slotCount;
+
+    auto slots() noexcept -> BoardSlot * { return reinterpret_cast<BoardSlot *>(this + 1); }
+    static auto sizeFor(uint32_t slotCount) noexcept -> size_t {
+        return sizeof(Header) + size_t{slotCount} * sizeof(BoardSlot);
+    }
+};
+
+auto FlagBoard::slotCount() const noexcept -> uint32_t { return header->slotCount; }
+
+auto FlagBoard::lookup(std::string_view name, uint64_t hash, bool create) noexcept
+    -> std::pair<BoardSlot *, bool> {
+    if (name.empty() || name.size() > nameSize) return {};
+
+    // Slots are claimed in order and never released, so all processes agree on the slot of a name.
+    auto slots = header->slots();
+    for (auto i = uint32_t{}; i < header->slotCount; i++) {
+        auto &slot = slots[i];
+        auto state = slot.state.load(std::memory_order_acquire);
+        if (state == BoardSlot::Free) {
+            if (!create) return {};
+            if (slot.state.compare_exchange_strong(state, BoardSlot::Busy, std::memory_order_acquire)) {
+                std::memcpy(slot.name, name.data(), name.size());
+                slot.name[name.size()] = '\0';
+                slot.layoutHash = hash;
+                return {&slot, true};
+            }
+        }
+        // another process is constructing the entry, if it died meanwhile the entry stays Busy for good
+        if (state == BoardSlot::Busy) {
+            const auto ready = waitFor([&] {
+                state = slot.state.load(std::memory_order_acquire);
+                return state != BoardSlot::Busy;
+            });
+            if (!ready) return {};
+        }
+        if (std::string_view{slot.name, strnlen(slot.name, BoardSlot::nameSize)} == name) {
+            if (slot.layoutHash != hash) return {};
+            return {&slot, false};
+        }
+    }
+    return {};
+}
+
+#ifdef CONCURRENT_HAS_FLAG_BOARD
+
+namespace {
+
+auto shmPath(std::string_view name) -> std::string {
+    auto path = std::string{"/"};
+    path.append(name.data(), name.size());
+    return path;
+}
+
+} // namespace
+
+auto FlagBoard::create(std::string_view name, uint32_t slotCount, uint32_t mode) noexcept -> std::optional<FlagBoard> {
+    if (slotCount == 0) return std::nullopt;
+    const auto path = shmPath(name);
+    const auto fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, static_cast<mode_t>(mode));
+    if (fd < 0) return errno == EEXIST ? open(name) : std::nullopt;
+
+    const auto size = Header::sizeFor(slotCount);
+    auto map = ftruncate(fd, static_cast<off_t>(size)) == 0
+        ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return std::nullopt;
+    }
+
+    // the file is zero filled, so all slots start Free
+    auto header = new (map) Header{};
+    header->version = Header::versionValue;
+    header->layout = Header::layoutValue;
+    header->slotCount = slotCount;
+    header->magic.store(Header::magicValue, std::memory_order_release);
+    return FlagBoard{header, size};
+}
+
+auto FlagBoard::open(std::string_view name) noexcept -> std::optional<FlagBoard> {
+    const auto fd = shm_open(shmPath(name).c_str(), O_RDWR, 0);
+    if (fd < 0) return std::nullopt;
+
+    // the creator may not have sized the file yet
+    struct stat st {};
+    const auto sized = waitFor([&] { return fstat(fd, &st) == 0 && st.st_size >= off_t{sizeof(Header)}; });
+    const auto size = static_cast<size_t>(st.st_size);
+    auto map = sized ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) return std::nullopt;
+
+    auto header = std::launder(reinterpret_cast<Header *>(map));
+    const auto valid = waitFor([&] { return header->magic.load(std::memory_order_acquire) == Header::magicValue; })
+        && header->version == Header::versionValue && header->layout == Header::layoutValue
+        && size >= Header::sizeFor(header->slotCount);
+    if (!valid) {
+        munmap(map, size);
+        return std::nullopt;
+    }
+    return FlagBoard{header, size};
+}
+
+bool FlagBoard::unlink(std::string_view name) noexcept { return shm_unlink(shmPath(name).c_str()) == 0; }
+
+FlagBoard::~FlagBoard() {
+    if (header != nullptr) munmap(header, size);
+}
+
+#else
+
+auto FlagBoard::create(std::string_view, uint32_t, uint32_t) noexcept -> std::optional<FlagBoard> {
+    return std::nullopt;
+}
+auto FlagBoard::open(std::string_view) noexcept -> std::optional<FlagBoard> { return std::nullopt; }
+bool FlagBoard::unlink(std::string_view) noexcept { return false; }
+FlagBoard::~FlagBoard() = default;
+
+#endif
+
+} // namespace concurrent
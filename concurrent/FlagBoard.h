@@ -0,0 +1,213 @@
+#pragma once
+#include "EventFlags.h"
+
+#include "bitnumber/Flags.h"
+#include "classic/Flags.h"
+#include "meta/Name.h"
+#include "meta/details/Hash.h"
+#include "repeated/Flags.h"
+#include "tagtype/Flags.h"
+#include "tagvalue/Flags.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace concurrent {
+
+namespace details {
+
+using meta::details::fnv1a;
+
+// Shared memory entry of a FlagBoard
+// The first cache line describes the entry, the second holds the EventFlags.
+struct alignas(64) BoardSlot {
+    static constexpr auto nameSize = size_t{48};
+    static constexpr auto storageSize = size_t{64};
+    enum State : uint32_t { Free, Busy, Ready };
+
+    std::atomic<uint32_t> state;
+    uint32_t reserved;
+    uint64_t layoutHash;
+    char name[nameSize];
+    alignas(64) unsigned char storage[storageSize];
+};
+
+} // namespace details
+
+namespace details {
+
+// adds the flag at bit index, identified by key (its name or value), to a layout hash
+constexpr auto layoutStep(uint64_t h, uint64_t index, uint64_t key) noexcept -> uint64_t {
+    return fnv1a(key, fnv1a(index, h));
+}
+
+template<auto V>
+constexpr auto valueKey() noexcept -> uint64_t {
+    if constexpr (std::is_enum_v<decltype(V)>)
+        return fnv1a(static_cast<uint64_t>(V), fnv1a(meta::valueName<V>));
+    else
+        return static_cast<uint64_t>(V);
+}
+
+// classic and bitnumber flags use the enum values as bits, every named value is part of the layout
+// enums without a fixed underlying type are not reflected, only their type name is part of the layout
+template<class E>
+constexpr auto enumLayout(uint64_t h) noexcept -> uint64_t {
+    if constexpr (meta::hasFixedUnderlying<E>) {
+        for (auto v = size_t{}; v < meta::enumNameRange; v++) {
+            const auto name = meta::details::enumNames<E>[v];
+            if (!name.empty()) h = layoutStep(h, v, fnv1a(name));
+        }
+        for (auto b = size_t{}; b < meta::details::enumBitNames<E>.size(); b++) {
+            const auto name = meta::details::enumBitNames<E>[b];
+            if (!name.empty()) h = layoutStep(h, uint64_t{1} << b, fnv1a(name));
+        }
+    }
+    return h;
+}
+
+template<class T>
+constexpr auto flagsLayout(uint64_t h, const classic::Flags<T> *) noexcept -> uint64_t {
+    return enumLayout<T>(h);
+}
+
+template<class T, class V>
+constexpr auto flagsLayout(uint64_t h, const bitnumber::Flags<T, V> *) noexcept -> uint64_t {
+    return enumLayout<T>(h);
+}
+
+template<auto... A>
+constexpr auto flagsLayout(uint64_t h, const repeated::Flags<A...> *) noexcept -> uint64_t {
+    using Flags = repeated::Flags<A...>;
+    h = fnv1a(uint64_t{Flags::bitCount}, h);
+    ((h = layoutStep(h, Flags::indexOf(A), valueKey<A>())), ...);
+    return h;
+}
+
+template<auto... A>
+constexpr auto flagsLayout(uint64_t h, const tagvalue::Flags<A...> *) noexcept -> uint64_t {
+    using Flags = tagvalue::Flags<A...>;
+    h = fnv1a(uint64_t{Flags::bitCount}, h);
+    const auto step = [&](auto flag) {
+        constexpr auto v = decltype(flag)::value;
+        if constexpr (!std::is_null_pointer_v<std::remove_const_t<decltype(v)>>)
+            h = layoutStep(h, Flags::template indexOf<v>(), valueKey<v>());
+    };
+    (step(std::integral_constant<decltype(A), A>{}), ...);
+    return h;
+}
+
+template<class... A>
+constexpr auto flagsLayout(uint64_t h, const tagtype::Flags<A...> *) noexcept -> uint64_t {
+    using Flags = tagtype::Flags<A...>;
+    h = fnv1a(uint64_t{Flags::bitCount}, h);
+    const auto step = [&](auto *tag) {
+        using T = std::remove_pointer_t<decltype(tag)>;
+        if constexpr (!std::is_void_v<T>) h = layoutStep(h, Flags::template indexOf<T>(), fnv1a(meta::typeName<T>));
+    };
+    (step(static_cast<A *>(nullptr)), ...);
+    return h;
+}
+
+} // namespace details
+
+// Fingerprint of a flags layout, readers compare it to reject entries written with a different layout
+// Covers the size, the bit count and the bit of every flag together with its name (see meta/Name.h),
+// so reordering, renumbering or renaming flags changes it. Tags are named without their namespace.
+template<class F>
+constexpr auto layoutHash() noexcept -> uint64_t {
+    auto h = details::fnv1a(std::string_view{"FlagBoard"});
+    h = details::fnv1a(uint64_t{sizeof(F)}, h);
+    h = details::fnv1a(uint64_t{alignof(F)}, h);
+    return details::flagsLayout(h, static_cast<const F *>(nullptr));
+}
+
+// Named, typed flags in /dev/shm shared by several processes
+//
+//     auto board = FlagBoard::create("services", 64);
+//     auto health = board->attach<HealthFlags>("db");
+//     health->set(HealthFlags{Health::Ready});           // other process: health->wait_all(...)
+//
+// Every entry is an EventFlags with shared futexes, so
+// * loads and tests are plain atomic loads without any syscall
+// * modifications are one atomic operation and only enter the kernel while a process waits
+// Entries are created on first attach and live as long as the board. Failures are reported as nullopt/nullptr.
+struct FlagBoard {
+    using This = FlagBoard;
+    template<class F>
+    using Entry = EventFlags<F, details::Futex::Scope::Shared>;
+
+    static constexpr auto nameSize = details::BoardSlot::nameSize - 1;
+
+    // Opens the board or creates it with room for slotCount entries
+    // mode are the permissions of a new board, only its owner may use it by default
+    static auto create(std::string_view name, uint32_t slotCount, uint32_t mode = 0600) noexcept
+        -> std::optional<FlagBoard>;
+    // Opens an existing board
+    static auto open(std::string_view name) noexcept -> std::optional<FlagBoard>;
+    // Removes the board name, existing mappings stay valid
+    static bool unlink(std::string_view name) noexcept;
+
+    FlagBoard(This &&o) noexcept
+        : header(std::exchange(o.header, nullptr))
+        , size(std::exchange(o.size, 0)) {}
+    auto operator=(This &&o) noexcept -> This & {
+        std::swap(header, o.header);
+        std::swap(size, o.size);
+        return *this;
+    }
+    ~FlagBoard();
+
+    auto slotCount() const noexcept -> uint32_t;
+
+    // Returns the entry called name and creates it if missing.
+    // nullptr if the entry has a different layout, the name is too long or the board is full,
+    // and if a process died while creating an entry on the way.
+    template<class F>
+    auto attach(std::string_view name) noexcept -> Entry<F> * {
+        return get<F>(name, true);
+    }
+
+    // Returns the existing entry called name or nullptr
+    template<class F>
+    auto find(std::string_view name) noexcept -> Entry<F> * {
+        return get<F>(name, false);
+    }
+
+private:
+    struct Header;
+
+    FlagBoard(Header *header, size_t size) noexcept
+        : header(header)
+        , size(size) {}
+
+    // Returns the slot of name and whether the caller has to construct it.
+    auto lookup(std::string_view name, uint64_t hash, bool create) noexcept -> std::pair<details::BoardSlot *, bool>;
+
+    template<class F>
+    auto get(std::string_view name, bool create) noexcept -> Entry<F> * {
+        static_assert(sizeof(Entry<F>) <= details::BoardSlot::storageSize, "flags too wide for a FlagBoard entry");
+        static_assert(alignof(Entry<F>) <= alignof(details::BoardSlot), "flags too aligned for a FlagBoard entry");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "process shared atomics have to be lock-free");
+        static_assert(Entry<F>::Atomic::isAlwaysLockFree, "process shared atomics have to be lock-free");
+
+        const auto [slot, construct] = lookup(name, layoutHash<F>(), create);
+        if (slot == nullptr) return nullptr;
+        if (construct) {
+            new (slot->storage) Entry<F>{};
+            slot->state.store(details::BoardSlot::Ready, std::memory_order_release);
+        }
+        return std::launder(reinterpret_cast<Entry<F> *>(slot->storage));
+    }
+
+private:
+    Header *header{};
+    size_t size{};
+};
+
+} // namespace concurrent
@@ -0,0 +1,11 @@
+#include "ShardedFlags.h"
+
+namespace concurrent::details {
+
+auto threadSlot() noexcept -> size_t {
+    static auto next = std::atomic<size_t>{};
+    thread_local const auto slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+} // namespace concurrent::details
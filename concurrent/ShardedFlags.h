@@ -0,0 +1,126 @@
+#pragma once
+#include "meta/details/CacheLine.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace concurrent {
+
+namespace details {
+
+using meta::details::cacheLineSize;
+
+// Returns a small number unique to the calling thread.
+// Numbers are handed out in order of the first call and never reused.
+auto threadSlot() noexcept -> size_t;
+
+} // namespace details
+
+// Per thread sharded flags
+// Every shard lives on its own cache line, a thread only writes the shard selected by its threadSlot.
+// Reads combine all used shards in one pass.
+//
+// A shard stores F as 64 bit words, each updated with its own fetch_or/fetch_and/fetch_xor, so any width works
+// and readers only load. Threads sharing a shard (more threads than Shards) stay correct.
+// Flags wider than 64 bits are not read as one snapshot, like the shards are not read at one instant.
+template<class F, size_t Shards = 64>
+struct ShardedFlags {
+    using This = ShardedFlags;
+    using Flags = F;
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+    static_assert(Shards > 0, "at least one shard is required");
+    static constexpr auto shardCount = Shards;
+    static constexpr auto wordCount = (sizeof(F) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Flags of one writer, the returned previous flags are combined from the previous words
+    struct alignas(details::cacheLineSize) Shard {
+        auto load(std::memory_order order = std::memory_order_acquire) const noexcept -> F {
+            uint64_t buffer[wordCount];
+            for (auto i = size_t{}; i < wordCount; i++) buffer[i] = words[i].load(order);
+            return fromBuffer(buffer);
+        }
+
+        auto set(F f, std::memory_order order = std::memory_order_release) noexcept -> F {
+            return apply(f, [order](std::atomic<uint64_t> &w, uint64_t b) { return w.fetch_or(b, order); });
+        }
+        auto reset(F f, std::memory_order order = std::memory_order_release) noexcept -> F {
+            return apply(f, [order](std::atomic<uint64_t> &w, uint64_t b) { return w.fetch_and(~b, order); });
+        }
+        auto flip(F f, std::memory_order order = std::memory_order_release) noexcept -> F {
+            return apply(f, [order](std::atomic<uint64_t> &w, uint64_t b) { return w.fetch_xor(b, order); });
+        }
+
+    private:
+        friend struct ShardedFlags;
+
+        template<class Op>
+        auto apply(F f, Op &&op) noexcept -> F {
+            uint64_t buffer[wordCount] = {};
+            std::memcpy(buffer, &f, sizeof(F));
+            for (auto i = size_t{}; i < wordCount; i++) buffer[i] = op(words[i], buffer[i]);
+            return fromBuffer(buffer);
+        }
+
+        std::atomic<uint64_t> words[wordCount]{};
+        std::atomic<bool> used{};
+    };
+    static_assert(sizeof(Shard) % details::cacheLineSize == 0, "a shard has to fill whole cache lines");
+
+    constexpr ShardedFlags() noexcept = default;
+    ShardedFlags(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    // shard of the calling thread
+    auto local() noexcept -> Shard & { return at(details::threadSlot() % Shards); }
+
+    // shard by explicit index, for workers that already have a number
+    auto at(size_t index) noexcept -> Shard & {
+        auto &s = shards[index];
+        if (!s.used.load(std::memory_order_relaxed)) s.used.store(true, std::memory_order_relaxed);
+        return s;
+    }
+
+    auto set(F f, std::memory_order order = std::memory_order_release) noexcept -> F { return local().set(f, order); }
+    auto reset(F f, std::memory_order order = std::memory_order_release) noexcept -> F {
+        return local().reset(f, order);
+    }
+    auto flip(F f, std::memory_order order = std::memory_order_release) noexcept -> F { return local().flip(f, order); }
+
+    // flags set in any used shard
+    auto aggregate_or(std::memory_order order = std::memory_order_acquire) const noexcept -> F {
+        uint64_t buffer[wordCount] = {};
+        for (auto &s : shards) {
+            if (!s.used.load(std::memory_order_relaxed)) continue;
+            for (auto i = size_t{}; i < wordCount; i++) buffer[i] |= s.words[i].load(order);
+        }
+        return fromBuffer(buffer);
+    }
+
+    // flags set in every used shard
+    auto aggregate_and(std::memory_order order = std::memory_order_acquire) const noexcept -> F {
+        uint64_t buffer[wordCount] = {};
+        auto first = true;
+        for (auto &s : shards) {
+            if (!s.used.load(std::memory_order_relaxed)) continue;
+            for (auto i = size_t{}; i < wordCount; i++)
+                buffer[i] = first ? s.words[i].load(order) : buffer[i] & s.words[i].load(order);
+            first = false;
+        }
+        return fromBuffer(buffer);
+    }
+
+private:
+    static auto fromBuffer(const uint64_t *buffer) noexcept -> F {
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), buffer, sizeof(F));
+        return r;
+    }
+
+private:
+    Shard shards[Shards]{};
+};
+
+} // namespace concurrent
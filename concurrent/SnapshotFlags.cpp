@@ -0,0 +1,7 @@
+#include "SnapshotFlags.h"
+
+namespace concurrent {
+
+// TODO
+
+} // namespace concurrent
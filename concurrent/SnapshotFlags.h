@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+
+namespace concurrent {
+
+// SeqLock protected flags of any width (e.g. multi-word tagtype::Flags or repeated::Flags)
+//
+// Readers never write shared memory and never block writers.
+// They copy all words and retry only if a writer was active meanwhile, so every load returns a consistent snapshot.
+// Writers serialise on the sequence word and apply their whole change in one critical section.
+template<class F>
+struct SnapshotFlags {
+    using This = SnapshotFlags;
+    using Flags = F;
+    static_assert(std::is_trivially_copyable_v<F>, "flags have to be trivially copyable");
+
+    static constexpr auto wordCount = (sizeof(F) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    SnapshotFlags() noexcept = default;
+    SnapshotFlags(F f) noexcept { write(f); }
+    SnapshotFlags(const This &) = delete;
+    auto operator=(const This &) -> This & = delete;
+
+    auto load() const noexcept -> F {
+        uint64_t buffer[wordCount];
+        while (true) {
+            const auto s1 = sequence.load(std::memory_order_acquire);
+            if (s1 & 1) continue; // writer active
+            for (auto i = size_t{}; i < wordCount; i++) buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == s1) break;
+        }
+        return fromBuffer(buffer);
+    }
+    operator F() const noexcept { return load(); }
+
+    bool operator[](F f) const noexcept { return load().any(f); }
+    bool any(F f) const noexcept { return load().any(f); }
+    bool all(F f) const noexcept { return load().all(f); }
+    bool none(F f) const noexcept { return load().none(f); }
+
+    // Applies f(F) -> F in one critical section and returns the previous flags.
+    template<class Fn>
+    auto update(Fn &&fn) noexcept -> F {
+        const auto s = lock();
+        const auto prev = read();
+        write(fn(prev));
+        sequence.store(s + 2, std::memory_order_release);
+        return prev;
+    }
+
+    void store(F f) noexcept {
+        update([f](F) { return f; });
+    }
+    auto set(F f) noexcept -> F {
+        return update([f](F v) { return v.set(f); });
+    }
+    auto reset(F f) noexcept -> F {
+        return update([f](F v) { return v.reset(f); });
+    }
+    auto flip(F f) noexcept -> F {
+        return update([f](F v) { return v.flip(f); });
+    }
+    auto mask(F f) noexcept -> F {
+        return update([f](F v) { return v.mask(f); });
+    }
+
+private:
+    // returns the even sequence number before the critical section
+    auto lock() noexcept -> uint64_t {
+        auto s = sequence.load(std::memory_order_relaxed);
+        while (true) {
+            if (!(s & 1) && sequence.compare_exchange_weak(s, s + 1, std::memory_order_acquire)) break;
+            s = sequence.load(std::memory_order_relaxed);
+        }
+        // orders the odd sequence before the following word stores
+        std::atomic_thread_fence(std::memory_order_release);
+        return s;
+    }
+
+    // only valid inside the critical section
+    auto read() const noexcept -> F {
+        uint64_t buffer[wordCount];
+        for (auto i = size_t{}; i < wordCount; i++) buffer[i] = words[i].load(std::memory_order_relaxed);
+        return fromBuffer(buffer);
+    }
+    void write(F f) noexcept {
+        uint64_t buffer[wordCount] = {};
+        std::memcpy(buffer, &f, sizeof(F));
+        for (auto i = size_t{}; i < wordCount; i++) words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    static auto fromBuffer(const uint64_t *buffer) noexcept -> F {
+        auto r = F{};
+        std::memcpy(static_cast<void *>(&r), buffer, sizeof(F));
+        return r;
+    }
+
+private:
+    std::atomic<uint64_t> sequence{};
+    std::atomic<uint64_t> words[wordCount]{};
+};
+
+} // namespace concurrent
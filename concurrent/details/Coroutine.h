@@ -0,0 +1,21 @@
+#pragma once
+
+// Selects the standard or the TS coroutine header
+// gcc needs -fcoroutines, clang -fcoroutines-ts and msvc /await (see cpp17_flags.qbs)
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+namespace concurrent::details::coro {
+using std::coroutine_handle;
+using std::suspend_always;
+using std::suspend_never;
+} // namespace concurrent::details::coro
+#elif defined(__cpp_coroutines) && __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+namespace concurrent::details::coro {
+using std::experimental::coroutine_handle;
+using std::experimental::suspend_always;
+using std::experimental::suspend_never;
+} // namespace concurrent::details::coro
+#else
+#error "coroutines are not enabled for this compiler"
+#endif
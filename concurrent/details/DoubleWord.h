@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cinttypes>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange128)
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if (defined(__GNUC__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)) || (defined(_MSC_VER) && defined(_M_X64))
+#define CONCURRENT_HAS_DOUBLE_WORD_CAS 1
+#endif
+
+namespace concurrent::details {
+
+// 128 bit value with the bit operators AtomicFlags needs
+struct alignas(16) DoubleWord {
+    uint64_t lo{};
+    uint64_t hi{};
+
+    constexpr bool operator==(const DoubleWord &o) const noexcept { return lo == o.lo && hi == o.hi; }
+    constexpr bool operator!=(const DoubleWord &o) const noexcept { return !(*this == o); }
+
+    constexpr auto operator~() const noexcept -> DoubleWord { return {~lo, ~hi}; }
+    constexpr auto operator|(const DoubleWord &o) const noexcept -> DoubleWord { return {lo | o.lo, hi | o.hi}; }
+    constexpr auto operator&(const DoubleWord &o) const noexcept -> DoubleWord { return {lo & o.lo, hi & o.hi}; }
+    constexpr auto operator^(const DoubleWord &o) const noexcept -> DoubleWord { return {lo ^ o.lo, hi ^ o.hi}; }
+};
+
+// std::atomic like cell for a DoubleWord built on cmpxchg16b
+// Read-modify-write operations are CAS loops that back off exponentially under contention.
+// Memory orders are accepted for interface compatibility, cmpxchg16b is always sequentially consistent.
+// load() is a locked cmpxchg16b as well, it needs write access and faults on read-only pages.
+struct AtomicDoubleWord {
+    static constexpr bool is_always_lock_free =
+#ifdef CONCURRENT_HAS_DOUBLE_WORD_CAS
+        true;
+#else
+        false;
+#endif
+
+    constexpr AtomicDoubleWord() noexcept = default;
+    constexpr AtomicDoubleWord(DoubleWord v) noexcept
+        : v(v) {}
+    AtomicDoubleWord(const AtomicDoubleWord &) = delete;
+    auto operator=(const AtomicDoubleWord &) -> AtomicDoubleWord & = delete;
+
+    bool is_lock_free() const noexcept { return is_always_lock_free; }
+
+    auto load(std::memory_order = std::memory_order_seq_cst) const noexcept -> DoubleWord {
+        // a compare exchange that writes back the current value is the only atomic 16 byte read
+        auto expected = DoubleWord{};
+        cas(const_cast<DoubleWord &>(v), expected, expected);
+        return expected;
+    }
+    void store(DoubleWord d, std::memory_order order = std::memory_order_seq_cst) noexcept { exchange(d, order); }
+    auto exchange(DoubleWord d, std::memory_order = std::memory_order_seq_cst) noexcept -> DoubleWord {
+        return update([d](DoubleWord) { return d; });
+    }
+
+    bool compare_exchange_strong(DoubleWord &expected,
+                                 DoubleWord desired,
+                                 std::memory_order = std::memory_order_seq_cst,
+                                 std::memory_order = std::memory_order_seq_cst) noexcept {
+        return cas(v, expected, desired);
+    }
+
+    auto fetch_or(DoubleWord d, std::memory_order = std::memory_order_seq_cst) noexcept -> DoubleWord {
+        return update([d](DoubleWord o) { return o | d; });
+    }
+    auto fetch_and(DoubleWord d, std::memory_order = std::memory_order_seq_cst) noexcept -> DoubleWord {
+        return update([d](DoubleWord o) { return o & d; });
+    }
+    auto fetch_xor(DoubleWord d, std::memory_order = std::memory_order_seq_cst) noexcept -> DoubleWord {
+        return update([d](DoubleWord o) { return o ^ d; });
+    }
+
+private:
+    // on failure expected receives the current value
+    static bool cas(DoubleWord &target, DoubleWord &expected, DoubleWord desired) noexcept {
+#if defined(_MSC_VER)
+        return _InterlockedCompareExchange128(reinterpret_cast<volatile long long *>(&target),
+                                              static_cast<long long>(desired.hi),
+                                              static_cast<long long>(desired.lo),
+                                              reinterpret_cast<long long *>(&expected)) != 0;
+#elif defined(CONCURRENT_HAS_DOUBLE_WORD_CAS)
+        __extension__ typedef unsigned __int128 Native;
+        const auto e = (Native{expected.hi} << 64) | expected.lo;
+        const auto d = (Native{desired.hi} << 64) | desired.lo;
+        const auto prev = __sync_val_compare_and_swap(reinterpret_cast<Native *>(&target), e, d);
+        if (prev == e) return true;
+        expected = {static_cast<uint64_t>(prev), static_cast<uint64_t>(prev >> 64)};
+        return false;
+#else
+        (void)target, (void)expected, (void)desired;
+        return false;
+#endif
+    }
+
+    static void pause(uint32_t count) noexcept {
+        for (auto i = uint32_t{}; i < count; i++) {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        }
+    }
+
+    template<class Fn>
+    auto update(Fn &&fn) noexcept -> DoubleWord {
+        auto expected = load();
+        auto backoff = uint32_t{1};
+        while (!cas(v, expected, fn(expected))) {
+            pause(backoff);
+            if (backoff < 1024) backoff *= 2;
+        }
+        return expected;
+    }
+
+private:
+    DoubleWord v{};
+};
+
+} // namespace concurrent::details
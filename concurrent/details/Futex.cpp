@@ -0,0 +1,73 @@
+#include "Futex.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#else
+#include <algorithm>
+#include <thread>
+#endif
+
+namespace concurrent::details {
+
+#ifdef __linux__
+
+namespace {
+
+auto futexAddress(const std::atomic<uint32_t> &word) noexcept -> uint32_t * {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires a plain 32 bit word");
+    return reinterpret_cast<uint32_t *>(const_cast<std::atomic<uint32_t> *>(&word));
+}
+
+} // namespace
+
+bool Futex::wait(const std::atomic<uint32_t> &word,
+                 uint32_t expected,
+                 uint32_t bitset,
+                 Clock::time_point deadline,
+                 Scope scope) noexcept {
+    // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout, which matches steady_clock on Linux
+    auto ts = timespec{};
+    auto timeout = static_cast<timespec *>(nullptr);
+    if (deadline != Clock::time_point::max()) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        timeout = &ts;
+    }
+    const auto op = scope == Scope::Private ? FUTEX_WAIT_BITSET_PRIVATE : FUTEX_WAIT_BITSET;
+    const auto r = syscall(SYS_futex, futexAddress(word), op, expected, timeout, nullptr, bitset);
+    return r == 0 || errno != ETIMEDOUT;
+}
+
+void Futex::wake(const std::atomic<uint32_t> &word, uint32_t bitset, Scope scope) noexcept {
+    const auto op = scope == Scope::Private ? FUTEX_WAKE_BITSET_PRIVATE : FUTEX_WAKE_BITSET;
+    syscall(SYS_futex, futexAddress(word), op, INT_MAX, nullptr, nullptr, bitset);
+}
+
+#else
+
+bool Futex::wait(const std::atomic<uint32_t> &word,
+                 uint32_t expected,
+                 uint32_t,
+                 Clock::time_point deadline,
+                 Scope) noexcept {
+    auto pause = std::chrono::microseconds{1};
+    while (word.load(std::memory_order_acquire) == expected) {
+        if (Clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(pause);
+        pause = std::min(pause * 2, std::chrono::microseconds{1000});
+    }
+    return true;
+}
+
+void Futex::wake(const std::atomic<uint32_t> &, uint32_t, Scope) noexcept {}
+
+#endif
+
+} // namespace concurrent::details
@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+
+namespace concurrent::details {
+
+// Thin wrapper around the Linux futex bitset operations
+// Other platforms fall back to polling with an increasing sleep.
+struct Futex {
+    using Clock = std::chrono::steady_clock;
+
+    // Private futexes are cheaper but only work between threads of one process.
+    // Shared futexes work on words in memory mapped by several processes.
+    enum class Scope { Private, Shared };
+
+    // Blocks while word == expected, until woken with an intersecting bitset or the deadline passes.
+    // Returns false on timeout. Spurious returns are possible, callers have to recheck their condition.
+    static bool wait(const std::atomic<uint32_t> &word,
+                     uint32_t expected,
+                     uint32_t bitset,
+                     Clock::time_point deadline,
+                     Scope scope = Scope::Private) noexcept;
+
+    // Wakes all waiters on word whose bitset intersects bitset.
+    static void wake(const std::atomic<uint32_t> &word, uint32_t bitset, Scope scope = Scope::Private) noexcept;
+
+    // Folds a mask of up to 64 bits into the 32 bit futex bitset.
+    // An empty mask matches every wake-up.
+    static constexpr auto bitset(uint64_t mask) noexcept -> uint32_t {
+        const auto r = static_cast<uint32_t>(mask) | static_cast<uint32_t>(mask >> 32);
+        return r != 0 ? r : ~uint32_t{};
+    }
+};
+
+} // namespace concurrent::details
@@ -0,0 +1,523 @@
+#include "codec/FlagsCodec.h"
+#include "columnar/BitSlicedFlags.h"
+#include "columnar/DictionaryFlags.h"
+#include "columnar/FlagsFile.h"
+#include "columnar/FlagsVector.h"
+#include "columnar/Histogram.h"
+#include "columnar/MaskCounts.h"
+#include "columnar/ParallelScan.h"
+#include "columnar/RoaringFlags.h"
+#include "columnar/Sort.h"
+#include "columnar/TextParser.h"
+#include "concurrent/SnapshotFlags.h"
+#include "repeated/Flags.h"
+#include "text/Format.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Wide { first, middle = 100, last = 255 };
+using WideFlags = repeated::Flags<Wide::first, Wide::middle, Wide::last>;
+
+enum class Small { s0, s7 = 7 };
+using SmallFlags = repeated::Flags<Small::s0, Small::s7>;
+
+enum class Sparse { s0, s1, s2, s63 = 63 };
+// all 64 values are listed, so every one of them has a name in text::FlagTable
+template<size_t... I>
+auto listSparse(std::index_sequence<I...>) -> repeated::Flags<static_cast<Sparse>(I)...>;
+using SparseFlags = decltype(listSparse(std::make_index_sequence<64>{}));
+
+auto operator<<(std::ostream &out, Sparse s) -> std::ostream & { return out << 's' << static_cast<int>(s); }
+
+constexpr auto sparseNames = [] {
+    auto r = std::array<std::array<char, 3>, 64>{};
+    for (auto i = 0; i < 64; i++)
+        r[i] = i < 10 ? std::array<char, 3>{'s', static_cast<char>('0' + i)}
+                      : std::array<char, 3>{'s', static_cast<char>('0' + i / 10), static_cast<char>('0' + i % 10)};
+    return r;
+}();
+constexpr auto name(Sparse s) noexcept -> std::string_view {
+    const auto i = static_cast<size_t>(s);
+    return {sparseNames[i].data(), i < 10 ? size_t{2} : size_t{3}};
+}
+
+void report(const char *name, uint64_t operations, Clock::duration time) {
+    const auto seconds = std::chrono::duration<double>(time).count();
+    std::cout << name << ": " << static_cast<uint64_t>(operations / seconds / 1e6) << " Mops/s\n";
+}
+
+void reportBandwidth(const char *name, uint64_t bytes, Clock::duration time) {
+    const auto seconds = std::chrono::duration<double>(time).count();
+    std::cout << name << ": " << static_cast<uint64_t>(bytes / seconds / 1e6) << " MB/s\n";
+}
+
+void reportLatency(const char *name, uint64_t queries, Clock::duration time) {
+    const auto seconds = std::chrono::duration<double>(time).count();
+    std::cout << name << ": " << seconds / queries * 1e6 << " us/query\n";
+}
+
+// keeps benchmark results alive
+volatile auto sink = size_t{};
+
+// Measures repeated passes of fn over data of the given size
+template<class Fn>
+void benchmarkPasses(const char *name, uint64_t bytes, Fn &&fn) {
+    auto result = size_t{};
+    auto passes = uint64_t{};
+    const auto start = Clock::now();
+    while (Clock::now() - start < std::chrono::milliseconds{500}) {
+        result += fn();
+        passes++;
+    }
+    const auto time = Clock::now() - start;
+    sink = result;
+    reportBandwidth(name, passes * bytes, time);
+}
+
+// Baseline for SnapshotFlags: the same flags behind a std::shared_mutex
+struct SharedMutexFlags {
+    auto load() const -> WideFlags {
+        auto lock = std::shared_lock<std::shared_mutex>{mutex};
+        return flags;
+    }
+    void flip(WideFlags f) {
+        auto lock = std::unique_lock<std::shared_mutex>{mutex};
+        flags = flags.flip(f);
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    WideFlags flags;
+};
+
+// Readers load snapshots while one writer flips bits continuously
+template<class Shared>
+void benchmarkSnapshots(const char *name, int readers) {
+    auto shared = Shared{};
+    auto stop = std::atomic<bool>{};
+    auto reads = std::atomic<uint64_t>{};
+
+    auto threads = std::vector<std::thread>{};
+    for (auto r = 0; r < readers; r++) {
+        threads.emplace_back([&] {
+            auto count = uint64_t{};
+            auto seen = uint64_t{};
+            while (!stop.load(std::memory_order_relaxed)) {
+                // a consistent snapshot always has first and last equal
+                const auto f = shared.load();
+                seen += f.any(Wide::first) == f.any(Wide::last);
+                count++;
+            }
+            if (seen != count) std::cout << "inconsistent snapshot\n";
+            reads += count;
+        });
+    }
+    threads.emplace_back([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            shared.flip(WideFlags{Wide::first, Wide::last});
+            std::this_thread::yield();
+        }
+    });
+
+    const auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    stop = true;
+    for (auto &t : threads) t.join();
+    report(name, reads, Clock::now() - start);
+}
+
+// count "all of a and none of b" over random rows, scalar loop against the FlagsVector and BitSlicedFlags kernels
+// Bandwidth is measured in bytes of row-major flags, so the bit-sliced figure shows the effective speed-up.
+template<class F, class E>
+void benchmarkFlagsVector(const char *name, int bits, size_t rows) {
+    auto random = std::mt19937{42};
+    auto any = [&] { return static_cast<E>(random() % static_cast<unsigned>(bits)); };
+    auto column = columnar::FlagsVector<F>{};
+    auto plain = std::vector<F>{};
+    column.reserve(rows);
+    plain.reserve(rows);
+    for (auto i = size_t{}; i < rows; i++) {
+        plain.push_back(F{}.set(any(), any(), any()));
+        column.push_back(plain.back());
+    }
+    const auto all = F{}.set(any());
+    const auto none = F{}.set(any());
+    const auto bytes = rows * sizeof(F);
+
+    std::cout << name << ", " << rows << " rows\n";
+    benchmarkPasses("  scalar all()/none()", bytes, [&] {
+        return static_cast<size_t>(
+            std::count_if(plain.begin(), plain.end(), [&](F f) { return f.all(all) && f.none(none); }));
+    });
+    benchmarkPasses("  FlagsVector::count_all_none", bytes, [&] { return column.count_all_none(all, none); });
+    const auto sliced = columnar::BitSlicedFlags<F>{column};
+    benchmarkPasses("  BitSlicedFlags::count_all_none", bytes, [&] { return sliced.count_all_none(all, none); });
+}
+
+// Latency of one query repeated for a while
+template<class Fn>
+void benchmarkQuery(const char *name, Fn &&fn) {
+    auto result = size_t{};
+    auto queries = uint64_t{};
+    const auto start = Clock::now();
+    while (Clock::now() - start < std::chrono::milliseconds{300}) {
+        result += fn();
+        queries++;
+    }
+    const auto time = Clock::now() - start;
+    sink = result;
+    reportLatency(name, queries, time);
+}
+
+// 64 flags, each set on 0.1% of the rows: dense bit slices against the roaring index
+void benchmarkSparse(size_t rows) {
+    auto random = std::mt19937{42};
+    auto column = columnar::FlagsVector<SparseFlags>(rows);
+    for (auto b = 0; b < 64; b++) {
+        for (auto n = size_t{}; n < rows / 1000; n++) {
+            const auto i = random() % rows;
+            column.set(i, column[i].set(static_cast<Sparse>(b)));
+        }
+    }
+    const auto sliced = columnar::BitSlicedFlags<SparseFlags>{column};
+    const auto index = *columnar::RoaringFlags<SparseFlags>::build(column);
+    const auto all = SparseFlags{Sparse::s0};
+    const auto pair = SparseFlags{Sparse::s0, Sparse::s1};
+    const auto none = SparseFlags{Sparse::s2};
+
+    std::cout << "64 flags at 0.1%, " << rows << " rows\n";
+    std::cout << "  BitSlicedFlags memory: " << SparseFlags::bitCount * sliced.bitmapWords() * 8 / 1024 << " KiB\n";
+    std::cout << "  RoaringFlags memory: " << index.bytes() / 1024 << " KiB\n";
+    benchmarkQuery("  BitSlicedFlags::count_all(s0)", [&] { return sliced.count_all(all); });
+    benchmarkQuery("  RoaringFlags::count_all(s0)", [&] { return index.count_all(all); });
+    benchmarkQuery("  BitSlicedFlags::count_all_none(s0|s1, s2)", [&] { return sliced.count_all_none(pair, none); });
+    benchmarkQuery("  RoaringFlags::count_all_none(s0|s1, s2)", [&] { return index.count_all_none(pair, none); });
+}
+
+// 64 flags but only 200 distinct combinations: plain FlagsVector against dictionary codes
+void benchmarkDictionary(size_t rows) {
+    auto random = std::mt19937{42};
+    auto combinations = std::vector<SparseFlags>{};
+    for (auto i = 0; i < 200; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        combinations.push_back(SparseFlags{}.set(at(), at(), at(), at()));
+    }
+    auto column = columnar::FlagsVector<SparseFlags>{};
+    auto dictionary = columnar::DictionaryFlags<SparseFlags>{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto f = combinations[random() % combinations.size()];
+        column.push_back(f);
+        dictionary.push_back(f);
+    }
+    const auto all = SparseFlags{Sparse::s0};
+    const auto none = SparseFlags{Sparse::s1};
+    const auto bytes = rows * sizeof(SparseFlags);
+
+    std::cout << "64 flags in 200 combinations, " << rows << " rows\n";
+    std::cout << "  DictionaryFlags memory: " << dictionary.bytes() / 1024 << " KiB of " << bytes / 1024 << " KiB\n";
+    benchmarkPasses("  FlagsVector::count_all_none", bytes, [&] { return column.count_all_none(all, none); });
+    benchmarkPasses("  DictionaryFlags::count_all_none", bytes, [&] { return dictionary.count_all_none(all, none); });
+}
+
+// 8 flags: scanning the column against the precomputed mask counts
+void benchmarkMaskCounts(size_t rows) {
+    auto random = std::mt19937{42};
+    auto column = columnar::FlagsVector<SmallFlags>{};
+    for (auto i = size_t{}; i < rows; i++) column.push_back(SmallFlags{}.set(static_cast<Small>(random() % 8)));
+    const auto counts = columnar::MaskCounts<SmallFlags>{column};
+    const auto all = SmallFlags{Small::s0};
+    const auto none = SmallFlags{Small::s7};
+
+    std::cout << "8 flags, " << rows << " rows\n";
+    benchmarkQuery("  FlagsVector::count_all_none(s0, s7)", [&] { return column.count_all_none(all, none); });
+    benchmarkQuery("  MaskCounts::count_all_none(s0, s7)", [&] { return counts.count_all_none(all, none); });
+}
+
+// Rows per flag: one counter increment per set flag against the vertical popcount
+template<class F, class E>
+void benchmarkHistogram(const char *name, int bits, size_t rows) {
+    auto random = std::mt19937{42};
+    auto any = [&] { return static_cast<E>(random() % static_cast<unsigned>(bits)); };
+    auto plain = std::vector<F>{};
+    for (auto i = size_t{}; i < rows; i++) plain.push_back(F{}.set(any(), any(), any()));
+    const auto bytes = rows * sizeof(F);
+
+    std::cout << name << ", " << rows << " rows\n";
+    benchmarkPasses("  per flag loop", bytes, [&] {
+        auto counts = columnar::FlagHistogram<F>{};
+        for (auto f : plain)
+            for (auto b = 0; b < bits; b++) counts[b] += f[static_cast<E>(b)];
+        return size_t{counts[0]};
+    });
+    benchmarkPasses("  columnar::histogram", bytes, [&] { return size_t{columnar::histogram(plain)[0]}; });
+}
+
+// 64 flags in few combinations: bucketing with a hash map against one radix sort
+void benchmarkGrouping(size_t rows) {
+    auto random = std::mt19937{42};
+    auto values = std::vector<SparseFlags>{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 12); };
+        values.push_back(SparseFlags{}.set(at(), at()));
+    }
+    const auto mask = SparseFlags{}.set(Sparse::s0, Sparse::s1, Sparse::s2, static_cast<Sparse>(9));
+    const auto bytes = rows * sizeof(SparseFlags);
+
+    std::cout << "64 flags, " << rows << " rows\n";
+    benchmarkPasses("  std::sort", bytes, [&] {
+        auto sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted.size();
+    });
+    benchmarkPasses("  columnar::radix_sort", bytes, [&] {
+        auto sorted = values;
+        auto permutation = std::vector<uint32_t>{};
+        columnar::radix_sort(sorted, &permutation);
+        return sorted.size();
+    });
+    benchmarkPasses("  std::unordered_map buckets", bytes, [&] {
+        auto buckets = std::unordered_map<uint64_t, std::vector<uint32_t>>{};
+        for (auto i = size_t{}; i < values.size(); i++) {
+            auto key = uint64_t{};
+            const auto masked = values[i] & mask;
+            std::memcpy(&key, &masked, sizeof(key));
+            buckets[key].push_back(static_cast<uint32_t>(i));
+        }
+        return buckets.size();
+    });
+    benchmarkPasses("  columnar::group_by_mask", bytes, [&] {
+        auto grouped = values;
+        auto permutation = std::vector<uint32_t>{};
+        return columnar::group_by_mask(grouped, mask, &permutation).size();
+    });
+}
+
+// 64 flags: the same queries on 1, 2, 4 ... threads
+void benchmarkScaling(size_t rows) {
+    auto random = std::mt19937{42};
+    auto column = columnar::FlagsVector<SparseFlags>{};
+    column.reserve(rows);
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        column.push_back(SparseFlags{}.set(at(), at(), at()));
+    }
+    const auto all = SparseFlags{Sparse::s0};
+    const auto none = SparseFlags{Sparse::s1};
+    const auto bytes = rows * sizeof(SparseFlags);
+
+    std::cout << "64 flags, " << rows << " rows\n";
+    const auto hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (auto threads = 1u;; threads = std::min(threads * 2, hardware)) {
+        auto pool = columnar::ScanPool{threads};
+        const auto scan = columnar::ParallelScan<SparseFlags>{pool, column};
+        const auto prefix = "  " + std::to_string(threads) + " threads ";
+        benchmarkPasses((prefix + "count_all_none").c_str(), bytes, [&] { return scan.count_all_none(all, none); });
+        benchmarkPasses((prefix + "histogram").c_str(), bytes, [&] { return size_t{scan.histogram()[0]}; });
+        if (threads == hardware) break;
+    }
+}
+
+// 64 flags: opening a mapped flags file against reading the raw values back into a FlagsVector
+void benchmarkFlagsFile(size_t rows) {
+    const auto path = std::string{"flagsbench.flags"};
+    const auto rawPath = std::string{"flagsbench.raw"};
+    auto random = std::mt19937{42};
+    auto values = std::vector<SparseFlags>{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        values.push_back(SparseFlags{}.set(at(), at()));
+    }
+    {
+        auto writer = columnar::FlagsFileWriter<SparseFlags>::create(path, rows);
+        if (!writer) return;
+        for (const auto &v : values) writer->push_back(v);
+        writer->flush();
+        auto raw = std::fopen(rawPath.c_str(), "wb");
+        if (!raw) return;
+        std::fwrite(values.data(), sizeof(SparseFlags), values.size(), raw);
+        std::fclose(raw);
+    }
+    const auto mask = SparseFlags{Sparse::s0};
+
+    std::cout << "64 flags, " << rows << " rows\n";
+    benchmarkQuery("  read + FlagsVector + count_all", [&] {
+        auto raw = std::fopen(rawPath.c_str(), "rb");
+        auto loaded = std::vector<SparseFlags>(rows);
+        const auto read = std::fread(loaded.data(), sizeof(SparseFlags), rows, raw);
+        std::fclose(raw);
+        auto column = columnar::FlagsVector<SparseFlags>{};
+        column.reserve(read);
+        for (auto i = size_t{}; i < read; i++) column.push_back(loaded[i]);
+        return column.count_all(mask);
+    });
+    benchmarkQuery("  FlagsFile::open + count_all", [&] {
+        const auto file = columnar::FlagsFile<SparseFlags>::open(path);
+        return file ? file->view().count_all(mask) : size_t{};
+    });
+    std::remove(path.c_str());
+    std::remove(rawPath.c_str());
+}
+
+// 64 flags with 2 set per value: text through operator<< against the binary codec
+void benchmarkCodec(size_t rows) {
+    auto random = std::mt19937{42};
+    auto values = std::vector<SparseFlags>{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        values.push_back(SparseFlags{}.set(at(), at()));
+    }
+    const auto codec = codec::FlagsCodec<SparseFlags>{};
+    const auto bytes = rows * sizeof(SparseFlags);
+    auto decoded = std::vector<SparseFlags>(rows);
+
+    std::cout << "64 flags, " << rows << " values\n";
+    benchmarkPasses("  operator<< text", bytes, [&] {
+        auto text = std::ostringstream{};
+        auto &out = static_cast<std::ostream &>(text);
+        for (const auto &v : values) out << v << '\n';
+        return text.str().size();
+    });
+    for (auto mode : {codec::Mode::Packed, codec::Mode::Sparse}) {
+        const auto name = std::string{mode == codec::Mode::Packed ? "  packed" : "  sparse"};
+        auto buffer = std::vector<unsigned char>(codec.max_encoded_size(rows, mode));
+        auto size = size_t{};
+        benchmarkPasses((name + " encode").c_str(), bytes, [&] {
+            size = codec.encode(values.data(), rows, mode, buffer.data(), buffer.size());
+            return size;
+        });
+        benchmarkPasses((name + " decode").c_str(), bytes, [&] {
+            return codec.decode(buffer.data(), size, decoded.data(), decoded.size()).value_or(0);
+        });
+        std::cout << name << " size: " << size << " bytes\n";
+    }
+}
+
+// 64 flags as operator<< text: per line std::string splitting against the streaming parser
+void benchmarkTextParser(size_t rows) {
+    auto random = std::mt19937{42};
+    auto text = std::ostringstream{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        static_cast<std::ostream &>(text) << SparseFlags{}.set(at(), at(), at()) << '\n';
+    }
+    const auto input = text.str();
+    auto names = std::vector<std::string>{};
+    for (auto i = 0; i < 64; i++) names.push_back("s" + std::to_string(i));
+
+    std::cout << "64 flags, " << rows << " lines\n";
+    benchmarkPasses("  std::getline + split", input.size(), [&] {
+        auto lookup = std::unordered_map<std::string, size_t>{};
+        for (auto i = size_t{}; i < names.size(); i++) lookup[names[i]] = i;
+        auto column = columnar::FlagsVector<SparseFlags>{};
+        auto lines = std::istringstream{input};
+        for (auto line = std::string{}; std::getline(lines, line);) {
+            auto f = SparseFlags{};
+            auto tokens = std::istringstream{line};
+            for (auto token = std::string{}; tokens >> token;)
+                if (auto it = lookup.find(token); it != lookup.end()) f.set(static_cast<Sparse>(it->second));
+            column.push_back(f);
+        }
+        return column.size();
+    });
+    benchmarkPasses("  FlagsTextParser 1 MB chunks", input.size(), [&] {
+        auto parser = columnar::FlagsTextParser<SparseFlags>{names};
+        auto column = columnar::FlagsVector<SparseFlags>{};
+        for (auto at = size_t{}; at < input.size(); at += size_t{1} << 20)
+            parser.parse(std::string_view{input}.substr(at, size_t{1} << 20), column);
+        parser.finish(column);
+        return column.size();
+    });
+}
+
+void benchmarkFormat(size_t rows) {
+    auto random = std::mt19937{42};
+    auto values = std::vector<SparseFlags>{};
+    for (auto i = size_t{}; i < rows; i++) {
+        const auto at = [&] { return static_cast<Sparse>(random() % 64); };
+        values.push_back(SparseFlags{}.set(at(), at(), at()));
+    }
+    auto bytes = uint64_t{};
+    for (auto f : values) bytes += text::formatted_size(f);
+
+    std::cout << "64 flags, " << rows << " values\n";
+    benchmarkPasses("  std::ostringstream", bytes, [&] {
+        auto out = std::ostringstream{};
+        auto r = size_t{};
+        for (auto f : values) {
+            out.str({});
+            static_cast<std::ostream &>(out) << f;
+            r += static_cast<size_t>(out.tellp());
+        }
+        return r;
+    });
+    benchmarkPasses("  text::format_to", bytes, [&] {
+        char buffer[text::FormatTable<SparseFlags>::maxSize];
+        auto r = size_t{};
+        for (auto f : values) r += static_cast<size_t>(text::format_to(buffer, buffer + sizeof(buffer), f) - buffer);
+        return r;
+    });
+}
+
+} // namespace
+
+int main() {
+    const auto readers = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    std::cout << "-- snapshot reads of 256 flags, " << readers << " readers, 1 writer --\n";
+    benchmarkSnapshots<concurrent::SnapshotFlags<WideFlags>>("SnapshotFlags", readers);
+    benchmarkSnapshots<SharedMutexFlags>("std::shared_mutex", readers);
+
+    std::cout << "-- bulk queries --\n";
+    benchmarkFlagsVector<SmallFlags, Small>("8 flags", 8, size_t{1} << 24);
+    benchmarkFlagsVector<WideFlags, Wide>("256 flags", 256, size_t{1} << 22);
+
+    std::cout << "-- sparse flags --\n";
+    benchmarkSparse(size_t{1} << 24);
+
+    std::cout << "-- low cardinality --\n";
+    benchmarkDictionary(size_t{1} << 24);
+
+    std::cout << "-- mask counts --\n";
+    benchmarkMaskCounts(size_t{1} << 22);
+
+    std::cout << "-- histogram --\n";
+    benchmarkHistogram<SmallFlags, Small>("8 flags", 8, size_t{1} << 24);
+    benchmarkHistogram<SparseFlags, Sparse>("64 flags", 64, size_t{1} << 22);
+
+    std::cout << "-- sorting and grouping --\n";
+    benchmarkGrouping(size_t{1} << 22);
+
+    std::cout << "-- parallel scans --\n";
+    benchmarkScaling(size_t{1} << 24);
+
+    std::cout << "-- mapped files --\n";
+    benchmarkFlagsFile(size_t{1} << 22);
+
+    std::cout << "-- binary codec --\n";
+    benchmarkCodec(size_t{1} << 20);
+
+    std::cout << "-- text parsing --\n";
+    benchmarkTextParser(size_t{1} << 20);
+
+    std::cout << "-- text formatting --\n";
+    benchmarkFormat(size_t{1} << 20);
+}
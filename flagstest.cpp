@@ -1,7 +1,148 @@
+#include "bitnumber/Flags.h"
+#include "classic/Flags.h"
+#include "codec/FlagsCodec.h"
+#include "columnar/BitSlicedFlags.h"
+#include "columnar/DictionaryFlags.h"
+#include "columnar/FlagsFile.h"
+#include "columnar/FlagsVector.h"
+#include "columnar/Histogram.h"
+#include "columnar/MaskCounts.h"
+#include "columnar/ParallelScan.h"
+#include "columnar/RoaringFlags.h"
+#include "columnar/Sort.h"
+#include "columnar/TextParser.h"
+#include "concurrent/AsyncFlags.h"
+#include "concurrent/AtomicFlags.h"
+#include "concurrent/EventFlags.h"
+#include "concurrent/FlagBoard.h"
+#include "concurrent/ShardedFlags.h"
+#include "concurrent/SnapshotFlags.h"
+#include "repeated/Flags.h"
 #include "tagtype/Flags.h"
+#include "tagvalue/Flags.h"
+#include "text/Format.h"
+#include "text/Literal.h"
+#include "text/Parse.h"
 
 #include <QtTest>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// fire and forget coroutine for the awaitable tests
+struct Detached {
+    struct promise_type {
+        auto get_return_object() noexcept -> Detached { return {}; }
+        auto initial_suspend() noexcept { return concurrent::details::coro::suspend_never{}; }
+        auto final_suspend() noexcept { return concurrent::details::coro::suspend_never{}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// coroutine that stays suspended until its owner destroys it
+struct Owned {
+    struct promise_type {
+        auto get_return_object() noexcept -> Owned { return {Handle::from_promise(*this)}; }
+        auto initial_suspend() noexcept { return concurrent::details::coro::suspend_never{}; }
+        auto final_suspend() noexcept { return concurrent::details::coro::suspend_always{}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+    using Handle = concurrent::details::coro::coroutine_handle<promise_type>;
+    Handle handle;
+};
+
+enum class Pet { cat, dog, wolf };
+
+// the same flag names on other bits
+namespace before {
+enum class Led { red, green };
+}
+namespace after {
+enum class Led { green, red };
+}
+
+// named flags for the text tests
+enum class Animal { cat, dog, wolf = 3 };
+constexpr auto name(Animal a) noexcept -> std::string_view {
+    switch (a) {
+    case Animal::cat: return "Cat";
+    case Animal::dog: return "Dog";
+    case Animal::wolf: return "Wolf";
+    }
+    return {};
+}
+enum class Bird {};
+constexpr auto name(Bird) noexcept -> std::string_view { return "Bird"; }
+struct Fish;
+constexpr auto name(tagtype::Flag<Fish>) noexcept -> std::string_view { return "Fish"; }
+
+enum class Many { m0, m99 = 99 };
+constexpr auto manyNames = [] {
+    auto r = std::array<std::array<char, 4>, 100>{};
+    for (auto i = 0; i < 100; i++) r[i] = {'m', static_cast<char>('0' + i / 10), static_cast<char>('0' + i % 10), 0};
+    return r;
+}();
+constexpr auto name(Many m) noexcept -> std::string_view { return {manyNames[static_cast<size_t>(m)].data(), 3}; }
+template<size_t... I>
+auto listMany(std::index_sequence<I...>) -> repeated::Flags<static_cast<Many>(I)...>;
+using ManyFlags = decltype(listMany(std::make_index_sequence<100>{}));
+// flags without name(), named by reflection
+enum class Color { red, green, blue = 5 };
+enum class Perm : unsigned { read = 1, write = 2, admin = 1u << 10 };
+struct Cow;
+
+enum class Access { read = 1, write = 2, exec = 4 };
+constexpr auto name(Access a) noexcept -> std::string_view {
+    switch (a) {
+    case Access::read: return "Read";
+    case Access::write: return "Write";
+    case Access::exec: return "Exec";
+    }
+    return {};
+}
+
+template<class Flags, class F>
+auto awaitAllOwned(Flags &flags, F mask, std::vector<int> &log, int id) -> Owned {
+    auto r = co_await flags.when_all(mask);
+    log.push_back(r.all(mask) ? id : -id);
+}
+
+template<class Flags, class F>
+auto awaitAll(Flags &flags, F mask, std::vector<int> &log, int id) -> Detached {
+    auto r = co_await flags.when_all(mask);
+    log.push_back(r.all(mask) ? id : -id);
+}
+
+template<class Flags, class F, class Executor>
+auto awaitAny(Flags &flags, F mask, std::vector<int> &log, int id, Executor executor) -> Detached {
+    co_await flags.when_any(mask, executor);
+    log.push_back(id);
+}
+
+template<class Flags>
+auto awaitChanged(Flags &flags, std::vector<int> &log, int id) -> Detached {
+    co_await flags.when_changed();
+    log.push_back(id);
+}
+
 class flagsTest : public QObject {
     Q_OBJECT
 
@@ -12,6 +153,1021 @@ private slots:
         auto anded = flags & tagtype::Flag<int>{};
         QCOMPARE(anded, tagtype::Flag<int>{});
     }
+
+    void test__repeated_Flags__wide_runtime_matches_constexpr() {
+        enum class W { w0, w1 = 65, w2 = 130, w3 = 255 };
+        using Wide = repeated::Flags<W::w0, W::w1, W::w2, W::w3>;
+        constexpr auto a = Wide{W::w0, W::w2};
+        constexpr auto b = Wide{W::w2, W::w3};
+        constexpr auto o = a | b;
+        constexpr auto m = a & b;
+        constexpr auto f = a.flipAll();
+        constexpr auto all = a.all(b);
+        constexpr auto any = a.any(b);
+
+        // volatile prevents the compiler from folding everything to constants
+        volatile auto w = W::w1;
+        auto ra = Wide{W::w0, W::w2}.set(w).reset(w);
+        auto rb = Wide{W::w2, W::w3};
+        QCOMPARE(ra, a);
+        QVERIFY((ra | rb) == o);
+        QVERIFY((ra & rb) == m);
+        QVERIFY(ra.flipAll() == f);
+        QCOMPARE(ra.all(rb), all);
+        QCOMPARE(ra.any(rb), any);
+        QVERIFY(ra.flipAll().none(W::w0, W::w2));
+        QVERIFY(!ra.none());
+        QVERIFY(Wide{}.none());
+    }
+
+    void test__AtomicFlags__all_flavours() {
+        enum class C { a = 1 << 0, b = 1 << 1 };
+        enum class N { a, b };
+        auto check = [](auto a, auto b) {
+            using F = decltype(a);
+            auto f = concurrent::AtomicFlags<F>{};
+            QVERIFY(f.isAlwaysLockFree);
+            QVERIFY(f.none());
+            QVERIFY(f.set(a) == F{});
+            QVERIFY(f[a] && !f[b]);
+            QVERIFY(f.test_and_set(a | b) == a);
+            QVERIFY(f.all(a | b));
+            QVERIFY(f.reset(a) == (a | b));
+            QVERIFY(f.flip(a | b) == b);
+            QVERIFY(f.load() == a);
+            QVERIFY(f.compare_exchange(b, F{}) == a);
+            QVERIFY(f.compare_exchange(a, b) == a);
+            QVERIFY(f.load(std::memory_order_acquire) == b);
+        };
+        check(classic::Flags<C>{C::a}, classic::Flags<C>{C::b});
+        check(bitnumber::Flags<N>{N::a}, bitnumber::Flags<N>{N::b});
+        check(tagtype::Flags<char, int>{tagtype::Flag<char>{}}, tagtype::Flags<char, int>{tagtype::Flag<int>{}});
+        check(tagvalue::Flags<1, 2>{tagvalue::Flag<1>{}}, tagvalue::Flags<1, 2>{tagvalue::Flag<2>{}});
+        check(repeated::Flags<N::a, N::b>{N::a}, repeated::Flags<N::a, N::b>{N::b});
+    }
+
+    void test__Flags__total_order() {
+        enum class C : int { a = 1 << 0, b = 1 << 1, sign = -2147483647 - 1 };
+        enum class N { a, b };
+        auto check = [](auto a, auto b) {
+            using F = decltype(a);
+            QVERIFY(F{} < a && a < b && a < (a | b) && b < (a | b));
+            QVERIFY(b > a && a <= a && a >= a && !(b < a) && !(a < a));
+        };
+        check(classic::Flags<C>{C::a}, classic::Flags<C>{C::b});
+        check(classic::Flags<C>{C::b}, classic::Flags<C>{C::sign});
+        check(bitnumber::Flags<N>{N::a}, bitnumber::Flags<N>{N::b});
+        check(tagtype::Flags<char, int>{tagtype::Flag<char>{}}, tagtype::Flags<char, int>{tagtype::Flag<int>{}});
+        check(tagvalue::Flags<1, 2>{tagvalue::Flag<1>{}}, tagvalue::Flags<1, 2>{tagvalue::Flag<2>{}});
+
+        // the last word is the most significant one
+        enum class W { w0, w1, w100 = 100 };
+        using Wide = repeated::Flags<W::w0, W::w100>;
+        check(Wide{W::w1}, Wide{W::w100});
+    }
+
+    void test__AtomicFlags__concurrent_set() {
+        enum class N { n0, n63 = 63 };
+        using F = repeated::Flags<N::n0, N::n63>;
+        auto f = concurrent::AtomicFlags<F>{};
+        auto threads = std::vector<std::thread>{};
+        for (auto t = 0; t < 8; t++) {
+            threads.emplace_back([&, t] {
+                for (auto i = t; i < 64; i += 8) f.set(F{static_cast<N>(i)}, std::memory_order_relaxed);
+            });
+        }
+        for (auto &t : threads) t.join();
+        auto expected = F{};
+        for (auto i = 0; i < 64; i++) expected |= static_cast<N>(i);
+        QVERIFY(f.load() == expected);
+    }
+
+    void test__AtomicFlags__128bit_contention() {
+        enum class N { n0, n127 = 127 };
+        using F = repeated::Flags<N::n0, N::n127>;
+        using A = concurrent::AtomicFlags<F>;
+        static_assert(sizeof(F) == 16);
+        auto f = A{};
+        QVERIFY(A::isAlwaysLockFree && f.is_lock_free());
+
+        // every thread owns 16 bits: sets them, then flips the first and resets the second one
+        auto threads = std::vector<std::thread>{};
+        for (auto t = 0; t < 8; t++) {
+            threads.emplace_back([&, t] {
+                for (auto round = 0; round < 2000; round++) {
+                    for (auto i = 16 * t; i < 16 * t + 16; i++) f.set(F{static_cast<N>(i)}, std::memory_order_relaxed);
+                    f.flip(F{static_cast<N>(16 * t)});
+                    f.reset(F{static_cast<N>(16 * t + 1)});
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+        auto expected = F{};
+        for (auto i = 0; i < 128; i++)
+            if (i % 16 > 1) expected |= static_cast<N>(i);
+        QVERIFY(f.load() == expected);
+        QVERIFY(f.compare_exchange(expected, F{}) == expected);
+        QVERIFY(f.none());
+    }
+
+    void test__EventFlags__wait() {
+        using namespace std::chrono_literals;
+        enum class A { cat, dog, wolf };
+        using F = repeated::Flags<A::cat, A::dog, A::wolf>;
+        using E = concurrent::EventFlags<F>;
+        auto events = E{};
+
+        QVERIFY(!events.wait_any(F{A::cat, A::dog}, E::AutoClear::No, 5ms));
+
+        auto waiter = std::thread([&] {
+            auto r = events.wait_all(F{A::cat, A::dog}, E::AutoClear::Yes);
+            QVERIFY(r && r->all(A::cat, A::dog));
+        });
+        events.set(F{A::wolf});
+        events.set(F{A::cat});
+        std::this_thread::sleep_for(1ms);
+        events.set(F{A::dog});
+        waiter.join();
+        QVERIFY(events.load() == F{A::wolf});
+
+        auto clearer = std::thread([&] {
+            std::this_thread::sleep_for(1ms);
+            events.reset(F{A::wolf});
+        });
+        QVERIFY(events.wait_until_cleared(F{A::wolf}, 10s));
+        clearer.join();
+
+        events.set(F{A::cat, A::wolf});
+        auto r = events.wait_any(F{A::cat, A::dog}, E::AutoClear::Yes, 0ms);
+        QVERIFY(r && *r == F(A::cat, A::wolf));
+        QVERIFY(events.load() == F{A::wolf});
+    }
+
+    void test__AsyncFlags__when() {
+        using F = repeated::Flags<Pet::cat, Pet::dog, Pet::wolf>;
+        auto flags = concurrent::AsyncFlags<F>{};
+        auto log = std::vector<int>{};
+        auto queue = std::vector<concurrent::AsyncFlags<F>::Handle>{};
+        auto post = [&](auto h) { queue.push_back(h); };
+
+        awaitAll(flags, F{Pet::cat, Pet::dog}, log, 1);
+        awaitAny(flags, F{Pet::wolf}, log, 2, post);
+        awaitChanged(flags, log, 3);
+        QVERIFY(log.empty());
+
+        flags.set(F{Pet::cat});
+        QCOMPARE(log, std::vector<int>({3}));
+        flags.set(F{Pet::dog});
+        QCOMPARE(log, std::vector<int>({3, 1}));
+        flags.set(F{Pet::wolf});
+        QCOMPARE(log, std::vector<int>({3, 1}));
+        QCOMPARE(queue.size(), size_t{1});
+        queue.front().resume();
+        QCOMPARE(log, std::vector<int>({3, 1, 2}));
+
+        awaitAny(flags, F{Pet::cat}, log, 4, concurrent::InlineExecutor{});
+        QCOMPARE(log, std::vector<int>({3, 1, 2, 4}));
+    }
+
+    void test__AsyncFlags__destroyed_waiter() {
+        using F = repeated::Flags<Pet::cat, Pet::dog, Pet::wolf>;
+        auto flags = concurrent::AsyncFlags<F>{};
+        auto log = std::vector<int>{};
+        auto first = awaitAllOwned(flags, F{Pet::cat}, log, 1);
+        auto second = awaitAllOwned(flags, F{Pet::cat}, log, 2);
+        first.handle.destroy();
+        flags.set(F{Pet::cat});
+        QCOMPARE(log, std::vector<int>({2}));
+        QVERIFY(second.handle.done());
+        second.handle.destroy();
+    }
+
+    void test__ShardedFlags__aggregate() {
+        using F = repeated::Flags<Pet::cat, Pet::dog, Pet::wolf>;
+        auto sharded = concurrent::ShardedFlags<F, 4>{};
+        QVERIFY(sharded.aggregate_or() == F{});
+
+        auto threads = std::vector<std::thread>{};
+        for (auto t = 0; t < 6; t++) {
+            threads.emplace_back([&, t] {
+                for (auto i = 0; i < 1000; i++) {
+                    sharded.set(F{Pet::dog});
+                    if (t == 0) sharded.flip(F{Pet::cat});
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+        QVERIFY(sharded.aggregate_or() == F{Pet::dog});
+        QVERIFY(sharded.aggregate_and() == F{Pet::dog});
+
+        sharded.at(3).set(F{Pet::wolf});
+        QVERIFY(sharded.at(3).load() == F(Pet::dog, Pet::wolf));
+        QVERIFY(sharded.aggregate_or() == F(Pet::dog, Pet::wolf));
+        QVERIFY(sharded.aggregate_and() == F{Pet::dog});
+
+        // wider than an atomic word
+        enum class W { w0, w1 = 100, w2 = 200 };
+        using Wide = repeated::Flags<W::w0, W::w1, W::w2>;
+        auto wide = concurrent::ShardedFlags<Wide, 2>{};
+        QVERIFY(wide.at(0).set(Wide{W::w0, W::w2}) == Wide{});
+        QVERIFY(wide.at(1).set(Wide{W::w1, W::w2}) == Wide{});
+        QVERIFY(wide.aggregate_or() == Wide(W::w0, W::w1, W::w2));
+        QVERIFY(wide.aggregate_and() == Wide{W::w2});
+        QVERIFY(wide.at(1).flip(Wide{W::w0, W::w2}) == Wide(W::w1, W::w2));
+        QVERIFY(wide.at(1).reset(Wide{W::w1}) == Wide(W::w0, W::w1));
+        QVERIFY(wide.aggregate_and() == Wide{W::w0});
+    }
+
+    void test__SnapshotFlags__consistent() {
+        enum class W { w0, w1 = 100, w2 = 200 };
+        using F = repeated::Flags<W::w0, W::w1, W::w2>;
+        auto snapshot = concurrent::SnapshotFlags<F>{F{W::w1}};
+        auto stop = std::atomic<bool>{};
+        auto writer = std::thread([&] {
+            while (!stop) snapshot.flip(F{W::w0, W::w2});
+        });
+        auto inconsistent = 0;
+        for (auto i = 0; i < 100000; i++) {
+            const auto f = snapshot.load();
+            if (f.any(W::w0) != f.any(W::w2) || !f.any(W::w1)) inconsistent++;
+        }
+        stop = true;
+        writer.join();
+        QCOMPARE(inconsistent, 0);
+
+        const auto prev = snapshot.update([](F f) { return f.reset(W::w0, W::w2).set(W::w0); });
+        QVERIFY(prev.any(W::w1));
+        QVERIFY(snapshot.load() == F(W::w0, W::w1));
+    }
+
+    void test__FlagBoard__cross_process() {
+#if defined(__unix__)
+        using namespace std::chrono_literals;
+        using F = repeated::Flags<Pet::cat, Pet::dog, Pet::wolf>;
+        using Other = repeated::Flags<Pet::cat, Pet::dog>;
+        using E = concurrent::FlagBoard::Entry<F>;
+        const auto name = "flags17_test_" + std::to_string(getpid());
+
+        auto board = concurrent::FlagBoard::create(name, 4);
+        QVERIFY(board && board->slotCount() == 4);
+        struct stat st {};
+        const auto fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+        QVERIFY(fd >= 0 && fstat(fd, &st) == 0 && (st.st_mode & 0777) == 0600);
+        close(fd);
+        auto ready = board->attach<F>("ready");
+        QVERIFY(ready && ready->none());
+        QVERIFY(board->attach<F>("ready") == ready);
+        QVERIFY(board->find<Other>("ready") == nullptr);
+        QVERIFY(board->find<F>("missing") == nullptr);
+
+        const auto child = fork();
+        if (child == 0) {
+            // the child only shares the board name and the flags type
+            auto other = concurrent::FlagBoard::open(name);
+            auto flags = other ? other->find<F>("ready") : nullptr;
+            if (flags == nullptr) _exit(1);
+            std::this_thread::sleep_for(1ms);
+            flags->set(F{Pet::cat});
+            flags->set(F{Pet::dog});
+            _exit(flags->wait_until_cleared(F{Pet::dog}, 10s) ? 0 : 2);
+        }
+        const auto r = ready->wait_all(F{Pet::cat, Pet::dog}, E::AutoClear::Yes, 10s);
+        auto status = 0;
+        waitpid(child, &status, 0);
+        QVERIFY(concurrent::FlagBoard::unlink(name));
+        QVERIFY(r && r->all(Pet::cat, Pet::dog));
+        QVERIFY(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        QVERIFY(ready->load() == F{});
+#endif
+    }
+
+    void test__FlagBoard__layout_hash() {
+        using concurrent::layoutHash;
+        using Before = repeated::Flags<before::Led::red, before::Led::green>;
+        using After = repeated::Flags<after::Led::red, after::Led::green>;
+        QVERIFY(layoutHash<Before>() != layoutHash<After>());
+        QVERIFY(layoutHash<bitnumber::Flags<before::Led>>() != layoutHash<bitnumber::Flags<after::Led>>());
+        QVERIFY(layoutHash<classic::Flags<Access>>() != layoutHash<classic::Flags<Perm>>());
+        using Tags = tagtype::Flags<int, float>;
+        using Swapped = tagtype::Flags<float, int>;
+        QVERIFY(layoutHash<Tags>() != layoutHash<Swapped>());
+        using Values = tagvalue::Flags<Pet::cat, nullptr, 7>;
+        using Gapless = tagvalue::Flags<Pet::cat, 7>;
+        QVERIFY(layoutHash<Values>() != layoutHash<Gapless>());
+    }
+
+    void test__FlagsVector__matches_scalar() {
+        enum class E { e0, e5 = 5, e11 = 11, e31 = 31, e63 = 63, e199 = 199 };
+        auto check = [](auto proto, int bits) {
+            using F = decltype(proto);
+            auto random = std::mt19937{42};
+            auto any = [&] { return static_cast<E>(random() % bits); };
+            auto rows = std::vector<F>{};
+            auto v = columnar::FlagsVector<F>{};
+            for (auto i = 0; i < 1000; i++) {
+                rows.push_back(F{}.set(any()).set(any()).set(any()));
+                v.push_back(rows.back());
+            }
+            QCOMPARE(v.size(), rows.size());
+
+            const auto all = F{}.set(any());
+            const auto mask = F{}.set(any(), any());
+            const auto none = F{}.set(any());
+            auto counts = std::vector<size_t>(4);
+            auto bitmap = std::vector<uint64_t>(v.bitmapWords());
+            auto first = v.npos;
+            for (auto i = size_t{}; i < rows.size(); i++) {
+                QVERIFY(v[i] == rows[i]);
+                counts[0] += rows[i].all(all);
+                counts[1] += rows[i].any(mask);
+                counts[2] += rows[i].none(mask);
+                counts[3] += rows[i].all(all) && rows[i].none(none);
+                if (rows[i].any(mask)) bitmap[i / 64] |= uint64_t{1} << (i % 64);
+                if (i >= 100 && first == v.npos && rows[i].all(all)) first = i;
+            }
+            QVERIFY(counts[0] > 0 && counts[1] > 0 && counts[2] > 0);
+            QCOMPARE(v.count_all(all), counts[0]);
+            QCOMPARE(v.count_any(mask), counts[1]);
+            QCOMPARE(v.count_none(mask), counts[2]);
+            QCOMPARE(v.count_all_none(all, none), counts[3]);
+            QVERIFY(v.bitmap_any(mask) == bitmap);
+            QCOMPARE(v.find_first_all(all, 100), first);
+            QCOMPARE(v.find_first_all(all, rows.size()), v.npos);
+
+            // shrinking clears the dropped rows
+            v.resize(10);
+            v.resize(70);
+            QCOMPARE(v.count_all(F{}), size_t{70});
+            QVERIFY(v[10] == F{} && v[69] == F{});
+            QVERIFY(v.find_first_none(F{}.flipAll(), 10) == 10);
+        };
+        check(repeated::Flags<E::e0, E::e5>{}, 6);
+        check(repeated::Flags<E::e0, E::e11>{}, 12);
+        check(repeated::Flags<E::e0, E::e31>{}, 32);
+        check(repeated::Flags<E::e0, E::e63>{}, 64);
+        check(repeated::Flags<E::e0, E::e199>{}, 200);
+    }
+
+    void test__BitSlicedFlags__matches_vector() {
+        enum class E { e0, e11 = 11, e199 = 199 };
+        auto check = [](auto proto, int bits) {
+            using F = decltype(proto);
+            auto random = std::mt19937{7};
+            auto any = [&] { return static_cast<E>(random() % bits); };
+            auto v = columnar::FlagsVector<F>{};
+            for (auto i = 0; i < 1000; i++) v.push_back(F{}.set(any(), any(), any()));
+
+            const auto sliced = columnar::BitSlicedFlags<F>{v};
+            QCOMPARE(sliced.size(), v.size());
+            QVERIFY(sliced[999] == v[999]);
+            const auto back = sliced.toVector();
+            for (auto i = size_t{}; i < v.size(); i++) QVERIFY(back[i] == v[i]);
+
+            for (auto n = 0; n < 20; n++) {
+                const auto all = F{}.set(any());
+                const auto none = F{}.set(any(), any());
+                QCOMPARE(sliced.count_all(all), v.count_all(all));
+                QCOMPARE(sliced.count_any(none), v.count_any(none));
+                QCOMPARE(sliced.count_none(none), v.count_none(none));
+                QCOMPARE(sliced.count_all_none(all, none), v.count_all_none(all, none));
+                QVERIFY(sliced.bitmap_all_none(all, none) == v.bitmap_all_none(all, none));
+                QVERIFY(sliced.bitmap_any(none) == v.bitmap_any(none));
+            }
+            QCOMPARE(sliced.count_all(F{}), v.size());
+        };
+        check(repeated::Flags<E::e0, E::e11>{}, 12);
+        check(repeated::Flags<E::e0, E::e199>{}, 200);
+    }
+
+    void test__RoaringBitmap__set_operations() {
+        using columnar::RoaringBitmap;
+        auto random = std::mt19937{3};
+        // sparse values, a dense chunk and a long run across chunk borders
+        auto build = [&](uint32_t sparse, uint32_t denseKey, uint32_t runFirst, uint32_t runLast) {
+            auto values = std::vector<uint32_t>{};
+            for (auto i = 0u; i < sparse; i++) values.push_back(random() % (1u << 22));
+            for (auto i = 0u; i < 20000; i++) values.push_back((denseKey << 16) | (random() & 0xffff));
+            for (auto v = runFirst; v < runLast; v++) values.push_back(v);
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            return values;
+        };
+        const auto va = build(3000, 5, 100000, 300000);
+        const auto vb = build(3000, 6, 250000, 260000);
+        auto a = RoaringBitmap{};
+        auto b = RoaringBitmap{};
+        for (auto i = va.size(); i-- > 0;) a.add(va[i]); // descending inserts
+        for (auto v : vb) b.add(v);
+        QCOMPARE(a.cardinality(), uint64_t{va.size()});
+        QVERIFY(a.values() == va && b.values() == vb);
+
+        const auto before = a.bytes();
+        a.optimize();
+        b.optimize();
+        QVERIFY(a.bytes() < before);
+        QVERIFY(a.values() == va && a.contains(150000) && !a.contains(1u << 23));
+
+        auto expected = std::vector<uint32_t>{};
+        std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+        QVERIFY((a & b).values() == expected);
+        expected.clear();
+        std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+        QVERIFY((a | b).values() == expected);
+        expected.clear();
+        std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+        QVERIFY((a - b).values() == expected);
+
+        const auto r = RoaringBitmap::range(65530, 131080);
+        QCOMPARE(r.cardinality(), uint64_t{131080 - 65530});
+        QVERIFY(r.contains(65530) && r.contains(131079) && !r.contains(131080));
+        QVERIFY((r - RoaringBitmap::range(65000, 140000)).empty());
+        // runs combined with runs stay runs instead of 8 KiB bitmaps
+        const auto overlap = r & RoaringBitmap::range(100000, 200000);
+        QCOMPARE(overlap.cardinality(), uint64_t{131080 - 100000});
+        QVERIFY(overlap.bytes() < 1024);
+        const auto joined = r | RoaringBitmap::range(0, 70000);
+        QVERIFY(joined.values() == RoaringBitmap::range(0, 131080).values() && joined.bytes() < 1024);
+        QVERIFY((a | r) - r == a - r);
+    }
+
+    void test__RoaringFlags__matches_vector() {
+        enum class E { rare, half, run, e11 = 11 };
+        using F = repeated::Flags<E::rare, E::e11>;
+        auto random = std::mt19937{5};
+        auto v = columnar::FlagsVector<F>{};
+        for (auto i = 0u; i < 200000; i++) {
+            auto f = F{};
+            if (random() % 1000 == 0) f = f.set(E::rare);
+            if (random() % 2 == 0) f = f.set(E::half);
+            if (i >= 1000 && i < 90000) f = f.set(E::run);
+            if (random() % 64 == 0) f = f.set(static_cast<E>(3 + random() % 9));
+            v.push_back(f);
+        }
+        const auto index = *columnar::RoaringFlags<F>::build(v);
+        QVERIFY(index.bytes() < v.size() * sizeof(F));
+        QVERIFY(index[1000] == v[1000] && index[199999] == v[199999]);
+
+        const auto masks = {F{E::rare}, F{E::half}, F{E::run}, F{E::rare, E::run}, F{E::e11}, F{}};
+        for (auto all : masks) {
+            for (auto none : masks) {
+                QCOMPARE(index.count_all_none(all, none), v.count_all_none(all, none));
+                QCOMPARE(index.count_any(all), v.count_any(all));
+                QCOMPARE(index.count_none(all), v.count_none(all));
+            }
+        }
+
+        const auto rows = index.rows_all_none(F{E::rare}, F{E::half});
+        const auto flags = index.materialize(rows);
+        auto i = size_t{};
+        rows.each([&](uint32_t row) { QVERIFY(flags[i++] == v[row]); });
+        QCOMPARE(i, flags.size());
+        QVERIFY(i > 0);
+    }
+
+    void test__DictionaryFlags__encodings() {
+        enum class E { e0, e63 = 63 };
+        using F = repeated::Flags<E::e0, E::e63>;
+        using D = columnar::DictionaryFlags<F>;
+        auto random = std::mt19937{11};
+        auto combination = [&](unsigned distinct) {
+            auto seed = std::mt19937{random() % distinct};
+            return F{}.set(static_cast<E>(seed() % 64), static_cast<E>(seed() % 64), static_cast<E>(seed() % 64));
+        };
+        auto check = [&](const D &d, const columnar::FlagsVector<F> &v) {
+            QCOMPARE(d.size(), v.size());
+            for (auto n = 0; n < 10; n++) {
+                const auto all = combination(1000).mask(v[n]);
+                const auto none = F{}.set(static_cast<E>(random() % 64));
+                QCOMPARE(d.count_all_none(all, none), v.count_all_none(all, none));
+                QCOMPARE(d.count_any(none), v.count_any(none));
+                QVERIFY(d.bitmap_all_none(all, none) == v.bitmap_all_none(all, none));
+                QVERIFY(d.bitmap_any(none) == v.bitmap_any(none));
+                QCOMPARE(d.find_first_all_none(all, none, 500), v.find_first_all_none(all, none, 500));
+            }
+        };
+
+        auto d = D{};
+        auto limited = D{300};
+        auto v = columnar::FlagsVector<F>{};
+        for (auto i = 0; i < 5000; i++) {
+            const auto f = combination(100);
+            d.push_back(f);
+            limited.push_back(f);
+            v.push_back(f);
+        }
+        QVERIFY(d.encoding() == D::Encoding::Byte);
+        QVERIFY(d.dictionary().size() <= 100 && d[4999] == v[4999]);
+        QVERIFY(d.bytes() < v.size() * sizeof(F) / 2); // codes, dictionary and its index
+        check(d, v);
+
+        for (auto i = 0; i < 5000; i++) {
+            const auto f = combination(1000);
+            d.push_back(f);
+            limited.push_back(f);
+            v.push_back(f);
+        }
+        d.set(7, F{E::e63});
+        limited.set(7, F{E::e63});
+        v.set(7, F{E::e63});
+        QVERIFY(d.encoding() == D::Encoding::Short);
+        QVERIFY(limited.encoding() == D::Encoding::Plain);
+        QVERIFY(d[7] == v[7] && limited[9999] == v[9999]);
+        check(d, v);
+        check(limited, v);
+    }
+
+    void test__histogram__matches_each_flag() {
+        enum class E { e0, e7 = 7, e9 = 9, e70 = 70 };
+        auto check = [](auto proto, int bits, size_t n) {
+            using F = decltype(proto);
+            auto random = std::mt19937{3};
+            auto any = [&] { return static_cast<E>(random() % bits); };
+            auto values = std::vector<F>{};
+            auto v = columnar::FlagsVector<F>{};
+            auto expected = columnar::FlagHistogram<F>{};
+            for (auto i = size_t{}; i < n; i++) {
+                // flag 0 is set in every value to reach the upper counter levels
+                values.push_back(F{}.set(any(), any(), any()).set(E::e0));
+                v.push_back(values.back());
+                for (auto b = 0; b < bits; b++) expected[b] += values.back()[static_cast<E>(b)];
+            }
+            QVERIFY(columnar::histogram(values) == expected);
+            QVERIFY(v.histogram() == expected);
+        };
+        for (auto n : {size_t{0}, size_t{1}, size_t{13}, size_t{1000}, size_t{600000}}) {
+            check(repeated::Flags<E::e0, E::e7>{}, 8, n);
+            check(repeated::Flags<E::e0, E::e9>{}, 10, n);
+        }
+        check(repeated::Flags<E::e0, E::e70>{}, 71, 5000);
+
+        using T = tagtype::Flags<char, int, float>;
+        const auto tags = std::vector<T>{T{tagtype::Flag<int>{}}, T::setAll(), T{}};
+        const auto counts = columnar::histogram(tags);
+        QCOMPARE(counts[T::indexOf(tagtype::Flag<char>{})], uint64_t{1});
+        QCOMPARE(counts[T::indexOf(tagtype::Flag<int>{})], uint64_t{2});
+    }
+
+    void test__radix_sort__matches_stable_sort() {
+        enum class E { e0, e9 = 9, e70 = 70 };
+        auto check = [](auto proto, int bits) {
+            using F = decltype(proto);
+            auto random = std::mt19937{11};
+            auto any = [&] { return static_cast<E>(random() % bits); };
+            auto values = std::vector<F>{};
+            for (auto i = 0; i < 5000; i++) values.push_back(F{}.set(any(), any()));
+
+            auto expected = values;
+            std::stable_sort(expected.begin(), expected.end());
+            auto sorted = values;
+            auto permutation = std::vector<uint32_t>{};
+            columnar::radix_sort(sorted, &permutation);
+            QVERIFY(sorted == expected);
+            auto payload = values;
+            columnar::reorder(payload, permutation);
+            QVERIFY(payload == sorted);
+
+            const auto mask = F{}.set(E::e0, E::e9);
+            auto grouped = values;
+            const auto bounds = columnar::group_by_mask(grouped, mask, &permutation);
+            QCOMPARE(bounds.size(), size_t{5});
+            QCOMPARE(bounds.back(), values.size());
+            for (auto g = size_t{}; g + 1 < bounds.size(); g++) {
+                const auto key = grouped[bounds[g]] & mask;
+                for (auto i = bounds[g]; i < bounds[g + 1]; i++) {
+                    QVERIFY((grouped[i] & mask) == key);
+                    QVERIFY(grouped[i] == values[permutation[i]]);
+                    // stable inside a group
+                    if (i > bounds[g]) QVERIFY(permutation[i - 1] < permutation[i]);
+                }
+                if (g > 0) QVERIFY((grouped[bounds[g - 1]] & mask) < key);
+            }
+        };
+        check(repeated::Flags<E::e0, E::e9>{}, 10);
+        check(repeated::Flags<E::e0, E::e70>{}, 71);
+
+        auto empty = std::vector<repeated::Flags<E::e0, E::e9>>{};
+        columnar::radix_sort(empty);
+        QCOMPARE(columnar::group_by_mask(empty, {E::e0}), std::vector<size_t>{0});
+    }
+
+    void test__FlagsFile__roundtrip() {
+#if defined(__unix__)
+        enum class E { e0, e1, e9 = 9, e70 = 70 };
+        using F = repeated::Flags<E::e0, E::e70>;
+        const auto path = std::string{"/tmp/flagstest_"} + std::to_string(getpid()) + ".flags";
+        const auto names = std::vector<std::string>{"e0", "e1"};
+        auto random = std::mt19937{17};
+        auto any = [&] { return static_cast<E>(random() % 71); };
+        auto expected = columnar::FlagsVector<F>{};
+
+        {
+            auto writer = columnar::FlagsFileWriter<F>::create(path, 1000, names, 100);
+            QVERIFY(writer.has_value());
+            QCOMPARE(writer->capacity(), size_t{1024}); // pages of 128 rows
+            for (auto i = 0; i < 300; i++) {
+                expected.push_back(F{}.set(any(), any()));
+                QVERIFY(writer->push_back(expected[i]));
+            }
+            QVERIFY(writer->flush());
+        }
+        {
+            // continues in the partial third page
+            auto writer = columnar::FlagsFileWriter<F>::append(path);
+            QVERIFY(writer.has_value());
+            QCOMPARE(writer->size(), size_t{300});
+            for (auto i = 0; i < 200; i++) {
+                expected.push_back(F{}.set(any(), any(), E::e1));
+                QVERIFY(writer->push_back(expected[expected.size() - 1]));
+            }
+        }
+
+        auto file = columnar::FlagsFile<F>::open(path, names);
+        QVERIFY(file.has_value());
+        QCOMPARE(file->size(), expected.size());
+        QCOMPARE(file->names(), names);
+        QCOMPARE(file->verify(), columnar::FlagsFile<F>::npos);
+        const auto view = file->view();
+        for (auto i = size_t{}; i < expected.size(); i++) QVERIFY(view[i] == expected[i]);
+        QCOMPARE(view.histogram(), expected.histogram());
+        for (auto n = 0; n < 20; n++) {
+            const auto all = F{}.set(any());
+            const auto none = F{}.set(any(), any());
+            QCOMPARE(view.count_all_none(all, none), expected.count_all_none(all, none));
+            QCOMPARE(view.bitmap_any(none), expected.bitmap_any(none));
+        }
+
+        QVERIFY(!columnar::FlagsFile<F>::open(path, {"e0", "e9"}).has_value());
+        using Narrow = repeated::Flags<E::e0, E::e9>;
+        QVERIFY(!columnar::FlagsFile<Narrow>::open(path).has_value());
+        QVERIFY(!columnar::FlagsFile<F>::open(path + ".missing").has_value());
+
+        // flip one bit in the second page of the first plane
+        const auto fd = open(path.c_str(), O_RDWR);
+        QVERIFY(fd >= 0);
+        auto byte = char{};
+        QCOMPARE(pread(fd, &byte, 1, 4096 + 128 * 8 + 5), ssize_t{1});
+        byte ^= 1;
+        QCOMPARE(pwrite(fd, &byte, 1, 4096 + 128 * 8 + 5), ssize_t{1});
+        close(fd);
+        QCOMPARE(columnar::FlagsFile<F>::open(path)->verify(), size_t{1});
+        unlink(path.c_str());
+#endif
+    }
+
+    void test__FlagsFileWriter__move() {
+#if defined(__unix__)
+        enum class E { e0, e9 = 9 };
+        using F = repeated::Flags<E::e0, E::e9>;
+        using Writer = columnar::FlagsFileWriter<F>;
+        const auto path = std::string{"/tmp/flagstest_move_"} + std::to_string(getpid());
+        const auto first = path + "_1.flags";
+        const auto second = path + "_2.flags";
+        {
+            auto w1 = Writer::create(first, 100);
+            auto w2 = Writer::create(second, 100);
+            QVERIFY(w1 && w2);
+            QVERIFY(w1->push_back(F{E::e0}) && w1->push_back(F{E::e9}));
+            QVERIFY(w2->push_back(F{E::e9}));
+            *w1 = std::move(*w2); // flushes the rows of w1
+            QCOMPARE(w1->size(), size_t{1});
+            QCOMPARE(w2->size(), size_t{0});
+            QVERIFY(!w2->push_back(F{E::e0}) && !w2->flush());
+            QVERIFY(w1->push_back(F{E::e0}));
+
+            auto w3 = std::move(*w1);
+            QVERIFY(!w1->push_back(F{E::e0}));
+            QVERIFY(w3.push_back(F{}));
+        }
+        const auto a = columnar::FlagsFile<F>::open(first);
+        const auto b = columnar::FlagsFile<F>::open(second);
+        QVERIFY(a && b);
+        QCOMPARE(a->size(), size_t{2});
+        QVERIFY(a->view()[1] == F{E::e9});
+        QCOMPARE(b->size(), size_t{3});
+        QVERIFY(b->view()[0] == F{E::e9} && b->view()[1] == F{E::e0} && b->view()[2] == F{});
+        unlink(first.c_str());
+        unlink(second.c_str());
+#endif
+    }
+
+    void test__FlagsCodec__roundtrip() {
+        enum class C : int { a = 1 << 0, b = 1 << 5, sign = -2147483647 - 1 };
+        enum class N { n0, n7 = 7 };
+        enum class E { e0, e9 = 9, e63 = 63, e70 = 70 };
+        auto check = [](auto proto, auto any) {
+            using F = decltype(proto);
+            using Codec = codec::FlagsCodec<F>;
+            auto random = std::mt19937{19};
+            auto values = std::vector<F>{};
+            for (auto i = 0; i < 999; i++) values.push_back(i % 7 == 0 ? F{} : any(random) | any(random));
+            const auto codec = Codec{{"x"}};
+            for (auto mode : {codec::Mode::Packed, codec::Mode::Sparse}) {
+                const auto bytes = codec.encode(values, mode);
+                QCOMPARE(bytes.size(), Codec::encoded_size(values.data(), values.size(), mode));
+                QVERIFY(bytes.size() <= Codec::max_encoded_size(values.size(), mode));
+                QVERIFY(codec.decode(bytes) == values);
+
+                // allocation free kernels refuse small buffers
+                auto out = std::vector<F>(values.size());
+                QVERIFY(!codec.decode(bytes.data(), bytes.size(), out.data(), out.size() - 1));
+                auto small = std::vector<unsigned char>(bytes.size() - 1);
+                QCOMPARE(codec.encode(values.data(), values.size(), mode, small.data(), small.size()), size_t{});
+
+                auto truncated = bytes;
+                truncated.pop_back();
+                QVERIFY(!codec.decode(truncated));
+                QVERIFY(!Codec{{"y"}}.decode(bytes));
+            }
+            QCOMPARE(codec.encode(values).size(), Codec::headerSize + (values.size() * Codec::bitCount + 7) / 8);
+        };
+        check(classic::Flags<C>{}, [](auto &r) { return classic::Flags<C>{r() % 3 == 0 ? C::sign : C::b}; });
+        check(bitnumber::Flags<N>{}, [](auto &r) { return bitnumber::Flags<N>{static_cast<N>(r() % 8)}; });
+        check(tagvalue::Flags<1, 2, 3>{}, [](auto &r) {
+            return r() % 2 ? tagvalue::Flags<1, 2, 3>{tagvalue::Flag<1>{}} : tagvalue::Flags<1, 2, 3>{tagvalue::Flag<3>{}};
+        });
+        check(repeated::Flags<E::e0, E::e9>{}, [](auto &r) { return repeated::Flags<E::e0, E::e9>{static_cast<E>(r() % 10)}; });
+        check(repeated::Flags<E::e0, E::e63>{}, [](auto &r) { return repeated::Flags<E::e0, E::e63>{static_cast<E>(r() % 64)}; });
+        check(repeated::Flags<E::e0, E::e70>{}, [](auto &r) { return repeated::Flags<E::e0, E::e70>{static_cast<E>(r() % 71)}; });
+
+        // the wire format does not depend on the machine
+        using F = repeated::Flags<E::e0, E::e9>;
+        const auto bytes = codec::FlagsCodec<F>{}.encode({F{E::e0}, F{E::e9}, F{static_cast<E>(1)}});
+        const auto payload = std::vector<unsigned char>(bytes.begin() + 24, bytes.end());
+        QCOMPARE(bytes[0], (unsigned char)'F');
+        QCOMPARE(bytes[6], (unsigned char)10);
+        QCOMPARE(bytes[16], (unsigned char)3);
+        QCOMPARE(payload, (std::vector<unsigned char>{0x01, 0x00, 0x28, 0x00}));
+    }
+
+    void test__FlagsTextParser__chunks() {
+        enum class E { e0, e70 = 70 };
+        using F = repeated::Flags<E::e0, E::e70>;
+        auto names = std::vector<std::string>{};
+        for (auto i = 0; i <= 70; i++) names.push_back(i == 5 ? "" : "flag" + std::to_string(i));
+
+        auto random = std::mt19937{23};
+        auto expected = std::vector<F>{};
+        auto text = std::string{};
+        for (auto i = 0; i < 2000; i++) {
+            auto f = F{};
+            for (auto n = random() % 4; n > 0; n--) {
+                const auto b = random() % 71;
+                if (b != 5) f.set(static_cast<E>(b));
+            }
+            expected.push_back(f);
+            const auto indices = columnar::details::flagIndices(f);
+            if (indices.count == 0) text += "<None>";
+            for (auto b : indices) {
+                if (b != indices.at[0]) text += random() % 2 ? " | " : "|";
+                text += names[b];
+            }
+            text += random() % 5 == 0 ? "\r\n" : random() % 9 == 0 ? "\n\n" : "\n";
+        }
+        text.pop_back(); // the last line ends without a newline
+
+        for (auto chunkSize : {size_t{1}, size_t{7}, size_t{64}, size_t{1000}, text.size()}) {
+            auto parser = columnar::FlagsTextParser<F>{names};
+            auto column = columnar::FlagsVector<F>{};
+            for (auto at = size_t{}; at < text.size(); at += chunkSize)
+                parser.parse(std::string_view{text}.substr(at, chunkSize), column);
+            parser.finish(column);
+            QCOMPARE(parser.malformedLines(), uint64_t{});
+            QCOMPARE(parser.offset(), uint64_t{text.size()});
+            QCOMPARE(column.size(), expected.size());
+            for (auto i = size_t{}; i < expected.size(); i++) QVERIFY(column[i] == expected[i]);
+        }
+
+        // malformed lines are skipped and reported by offset
+        const auto bad = std::string{"flag1 | flag2\n"
+                                     "flag1 | flag5\n"
+                                     "flag1 flag2\n"
+                                     "| flag1\n"
+                                     "flag1 |\n"
+                                     "<None> | flag1\n"
+                                     "flag1 | <None>\n"
+                                     "flag3 | flag2222222222222222222222222222222222222222\n"
+                                     "flag70"};
+        for (auto chunkSize : {size_t{1}, size_t{5}, bad.size()}) {
+            auto parser = columnar::FlagsTextParser<F>{names};
+            auto column = columnar::FlagsVector<F>{};
+            for (auto at = size_t{}; at < bad.size(); at += chunkSize)
+                parser.parse(std::string_view{bad}.substr(at, chunkSize), column);
+            parser.finish(column);
+            QCOMPARE(column.size(), size_t{2});
+            QVERIFY(column[0] == F{}.set(static_cast<E>(1), static_cast<E>(2)));
+            QVERIFY(column[1] == F{E::e70});
+            QCOMPARE(parser.malformedLines(), uint64_t{7});
+            const auto &errors = parser.errors();
+            QCOMPARE(errors.size(), size_t{7});
+            const auto offsets = std::vector<uint64_t>{22, 34, 40, 55, 63, 79, 94};
+            const auto lengths = std::vector<uint64_t>{5, 5, 1, 0, 1, 6, 44};
+            for (auto i = size_t{}; i < errors.size(); i++) {
+                QCOMPARE(errors[i].offset, offsets[i]);
+                QCOMPARE(errors[i].length, lengths[i]);
+            }
+        }
+    }
+
+    void test__parse__all_flavours() {
+        using Animals = repeated::Flags<Animal::cat, Animal::dog, Animal::wolf>;
+        QVERIFY(text::parse<Animals>("Cat | Dog").value == Animals{}.set(Animal::cat, Animal::dog));
+        QVERIFY(text::parse<Animals>(" Wolf|Cat\n").value == Animals{}.set(Animal::cat, Animal::wolf));
+        QVERIFY(text::parse<Animals>("<None>").value == Animals{});
+        QCOMPARE(text::parse<Animals>("Cat | Cow").error, size_t{6});
+        QCOMPARE(text::parse<Animals>("Cat || Dog").error, size_t{5});
+        QCOMPARE(text::parse<Animals>("").error, size_t{0});
+        QCOMPARE(text::parse<Animals>("<None> | Cat").error, size_t{7});
+        QCOMPARE(text::parse<Animals>("Cat | <None>").error, size_t{6});
+        // only listed values are flags, dog lies between cat and wolf
+        using Wild = repeated::Flags<Animal::cat, Animal::wolf>;
+        QVERIFY(text::parse<Wild>("Wolf | Cat").value == Wild{}.set(Animal::cat, Animal::wolf));
+        QCOMPARE(text::parse<Wild>("Dog").error, size_t{0});
+        QCOMPARE(text::parse<Wild>("Cat | Dog").error, size_t{6});
+
+        using Mixed = tagvalue::Flags<Animal::dog, nullptr, Bird{}>;
+        const auto dogAndBird = Mixed{tagvalue::Flag<Animal::dog>{}, tagvalue::Flag<Bird{}>{}};
+        QVERIFY(text::parse<Mixed>("Bird | Dog").value == dogAndBird);
+        QCOMPARE(text::parse<Mixed>("Cat").error, size_t{0});
+        using Tags = tagtype::Flags<void, Fish>;
+        QVERIFY(text::parse<Tags>("Fish").value == Tags{tagtype::Flag<Fish>{}});
+
+        // every name of a large table is found through the perfect hash
+        static_assert(text::nameIndex<ManyFlags>.valid);
+        auto random = std::mt19937{29};
+        for (auto n = 0; n < 200; n++) {
+            const auto a = static_cast<Many>(random() % 100);
+            const auto b = static_cast<Many>(random() % 100);
+            auto line = std::string{name(a)} + " | " + std::string{name(b)};
+            QVERIFY(text::parse<ManyFlags>(line).value == ManyFlags{}.set(a, b));
+        }
+        QCOMPARE(text::parse<ManyFlags>("m01 | m100").error, size_t{6});
+    }
+
+    void test__format_to__all_flavours() {
+        auto buffer = std::array<char, 64>{};
+        const auto format = [&](auto f) {
+            const auto end = text::format_to(buffer.data(), buffer.data() + buffer.size(), f);
+            if (end == nullptr || static_cast<size_t>(end - buffer.data()) != text::formatted_size(f)) return std::string{"?"};
+            return std::string(buffer.data(), end);
+        };
+
+        using Animals = repeated::Flags<Animal::cat, Animal::dog, Animal::wolf>;
+        QCOMPARE(format(Animals{Animal::cat, Animal::wolf}), std::string{"Cat | Wolf"});
+        QCOMPARE(format(Animals{}), std::string{"<None>"});
+        QCOMPARE(text::FormatTable<Animals>::maxSize, std::string_view{"Cat | Dog | Wolf"}.size());
+        // bits of values that are not listed are not written
+        using Wild = repeated::Flags<Animal::cat, Animal::wolf>;
+        QCOMPARE(format(Wild{}.set(Animal::cat, Animal::dog)), std::string{"Cat"});
+        QCOMPARE(format(Wild{Animal::dog}), std::string{"<None>"});
+        QCOMPARE(text::FormatTable<Wild>::maxSize, std::string_view{"Cat | Wolf"}.size());
+
+        using Mixed = tagvalue::Flags<Animal::dog, nullptr, Bird{}>;
+        QCOMPARE(format(Mixed{tagvalue::Flag<Animal::dog>{}, tagvalue::Flag<Bird{}>{}}), std::string{"Dog | Bird"});
+        using Tags = tagtype::Flags<void, Fish>;
+        QCOMPARE(format(Tags{tagtype::Flag<Fish>{}}), std::string{"Fish"});
+        QCOMPARE(format(classic::Flags<Access>{Access::read, Access::exec}), std::string{"Read | Exec"});
+        QCOMPARE(format(bitnumber::Flags<Animal>{Animal::dog, Animal::wolf}), std::string{"Dog | Wolf"});
+
+        // text that does not fit
+        const auto pets = Animals{Animal::cat, Animal::dog};
+        QVERIFY(text::format_to(buffer.data(), buffer.data() + 8, pets) == nullptr);
+        QVERIFY(text::format_to(buffer.data(), buffer.data() + 9, pets) == buffer.data() + 9);
+        QVERIFY(text::format_to(buffer.data(), buffer.data() + 5, Animals{}) == nullptr);
+    }
+
+    void test__reflection__names() {
+        QVERIFY(meta::valueName<Color::green> == "green");
+        QVERIFY(meta::valueName<static_cast<Color>(4)>.empty());
+        QVERIFY(meta::typeName<Cow> == "Cow");
+        QVERIFY(meta::enumName(Perm::admin) == "admin");
+        QVERIFY(meta::enumName(static_cast<Perm>(3)).empty());
+
+        auto buffer = std::array<char, 64>{};
+        const auto format = [&](auto f) {
+            const auto end = text::format_to(buffer.data(), buffer.data() + buffer.size(), f);
+            return end == nullptr ? std::string{"?"} : std::string(buffer.data(), end);
+        };
+        using Colors = repeated::Flags<Color::red, Color::blue>;
+        QVERIFY(text::parse<Colors>("red | blue").value == Colors{}.set(Color::red, Color::blue));
+        QCOMPARE(format(Colors{Color::red, Color::blue}), std::string{"red | blue"});
+        QCOMPARE(format(Colors{Color::green, Color::blue}), std::string{"blue"});
+        using Tags = tagtype::Flags<Cow, Fish>;
+        QCOMPARE(format(Tags{tagtype::Flag<Cow>{}, tagtype::Flag<Fish>{}}), std::string{"Cow | Fish"});
+        using Values = tagvalue::Flags<Color::blue, Bird{}>;
+        QCOMPARE(format(Values{tagvalue::Flag<Color::blue>{}, tagvalue::Flag<Bird{}>{}}), std::string{"blue | Bird"});
+        QCOMPARE(format(classic::Flags<Perm>{Perm::read, Perm::admin}), std::string{"read | admin"});
+        QCOMPARE(format(bitnumber::Flags<Color>{Color::red, Color::blue}), std::string{"red | blue"});
+    }
+
+    void test__literal__flags() {
+        using namespace text::literals;
+        using Animals = repeated::Flags<Animal::cat, Animal::dog, Animal::wolf>;
+        constexpr Animals pets = "Cat | Dog"_flags;
+        static_assert(pets == Animals{Animal::cat, Animal::dog});
+        QVERIFY(pets == Animals{}.set(Animal::cat, Animal::dog));
+        QVERIFY(Animals{} == "<None>"_flags);
+
+        using Tags = tagtype::Flags<void, Fish>;
+        constexpr Tags fish = "Fish"_flags;
+        QVERIFY(fish == Tags{tagtype::Flag<Fish>{}});
+    }
+
+    void test__MaskCounts__lookups() {
+        enum class E { e0, e1, e2, e9 = 9 };
+        using F = repeated::Flags<E::e0, E::e9>;
+        auto random = std::mt19937{13};
+        auto any = [&] { return static_cast<E>(random() % 10); };
+        auto v = columnar::FlagsVector<F>{};
+        for (auto i = 0; i < 3000; i++) v.push_back(F{}.set(any(), any(), any()));
+
+        auto counts = columnar::MaskCounts<F>{v};
+        auto check = [&] {
+            QCOMPARE(counts.size(), uint64_t{v.size()});
+            for (auto n = 0; n < 30; n++) {
+                const auto all = F{}.set(any(), any());
+                const auto none = F{}.set(any(), any(), any());
+                QCOMPARE(size_t{counts.count_all(all)}, v.count_all(all));
+                QCOMPARE(size_t{counts.count_none(none)}, v.count_none(none));
+                QCOMPARE(size_t{counts.count_any(none)}, v.count_any(none));
+                QCOMPARE(size_t{counts.count_all_none(all, none)}, v.count_all_none(all, none));
+                auto exact = size_t{};
+                for (auto i = size_t{}; i < v.size(); i++) exact += v[i] == v[n];
+                QCOMPARE(size_t{counts.count_exact(v[n])}, exact);
+            }
+        };
+        check();
+
+        for (auto i = 0; i < 500; i++) {
+            const auto row = random() % v.size();
+            const auto f = F{}.set(any());
+            counts.update(v[row], f);
+            v.set(row, f);
+        }
+        check();
+
+        enum class Big { b0, b19 = 19 };
+        using G = repeated::Flags<Big::b0, Big::b19>;
+        const auto values = std::vector<G>{G{Big::b0}, G{Big::b0, Big::b19}, G{}};
+        auto big = columnar::MaskCounts<G>{values.begin(), values.end()};
+        QCOMPARE(big.count_all(G{Big::b0}), 2u);
+        QCOMPARE(big.count_none(G{Big::b19}), 2u);
+        big.remove(G{});
+        big.add(G{Big::b19});
+        QCOMPARE(big.count_any(G{Big::b19}), 2u);
+        QCOMPARE(big.count_all_none(G{Big::b19}, G{Big::b0}), 1u);
+    }
+
+    void test__ParallelScan__matches_serial() {
+        enum class E { e0, e9 = 9, e70 = 70 };
+        auto check = [](auto proto, int bits, size_t rows) {
+            using F = decltype(proto);
+            auto random = std::mt19937{7};
+            auto any = [&] { return static_cast<E>(random() % bits); };
+            auto v = columnar::FlagsVector<F>{};
+            for (auto i = size_t{}; i < rows; i++) v.push_back(F{}.set(any(), any()).set(E::e0));
+
+            for (auto threads : {size_t{1}, size_t{4}}) {
+                auto pool = columnar::ScanPool{threads};
+                QCOMPARE(pool.threadCount(), threads);
+                const auto scan = columnar::ParallelScan<F>{pool, v};
+                const auto all = F{}.set(any());
+                const auto none = F{}.set(any());
+                QCOMPARE(scan.count_all(all), v.count_all(all));
+                QCOMPARE(scan.count_any(none), v.count_any(none));
+                QCOMPARE(scan.count_none(none), v.count_none(none));
+                QCOMPARE(scan.count_all_none(all, none), v.count_all_none(all, none));
+                QVERIFY(scan.bitmap_any(none) == v.bitmap_any(none));
+                QVERIFY(scan.bitmap_all_none(all, none) == v.bitmap_all_none(all, none));
+
+                auto reducedOr = F{};
+                auto reducedAnd = rows ? v[0] : F{};
+                auto histogram = typename columnar::ParallelScan<F>::Histogram{};
+                for (auto i = size_t{}; i < rows; i++) {
+                    reducedOr = reducedOr | v[i];
+                    reducedAnd = reducedAnd & v[i];
+                    for (auto b = 0; b < bits; b++) histogram[b] += v[i][static_cast<E>(b)];
+                }
+                QVERIFY(scan.reduce_or() == reducedOr);
+                QVERIFY(scan.reduce_and() == reducedAnd);
+                QVERIFY(scan.histogram() == histogram);
+            }
+        };
+        check(repeated::Flags<E::e0, E::e9>{}, 10, 100000);
+        check(repeated::Flags<E::e0, E::e70>{}, 71, 40000);
+        check(repeated::Flags<E::e0, E::e9>{}, 10, 0);
+
+        // every morsel runs exactly once, also when workers steal
+        auto pool = columnar::ScanPool{8};
+        auto seen = std::vector<std::atomic<int>>(5000);
+        auto workers = std::atomic<size_t>{};
+        pool.run(seen.size(), [&](size_t worker, size_t m) {
+            if (m % 7 == 0) std::this_thread::sleep_for(std::chrono::microseconds{20});
+            workers.fetch_or(size_t{1} << worker);
+            seen[m]++;
+        });
+        QVERIFY(workers.load() < size_t{1} << 8);
+        QVERIFY(std::all_of(seen.begin(), seen.end(), [](auto &n) { return n == 1; }));
+    }
 };
 
 QTEST_APPLESS_MAIN(flagsTest)
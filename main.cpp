@@ -72,6 +72,7 @@ void usage() {
 #include "bitnumber/Flags.h"
 namespace bit_number_approach {
 enum class Animal { Cat, Dog, Wolf = 3 };
+constexpr auto maxBit(Animal) -> Animal { return Animal::Wolf; } // optional: selects uint8_t storage
 using Animals = bitnumber::Flags<Animal>;
 
 // hint: use this outside of namespace or it wont be usable there!
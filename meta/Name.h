@@ -1,5 +1,9 @@
 #pragma once
-#include "type_traits"
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 namespace meta {
 
@@ -15,4 +19,160 @@ struct HasName<T, std::void_t<decltype(name(std::declval<T>()))>> : std::true_ty
 template<class T>
 constexpr auto hasName = HasName<T>::value;
 
+// Enums with a fixed underlying type (all scoped enums) can hold every value of it.
+// Only those are list initializable from their underlying type (C++17).
+template<class E, class = void>
+struct HasFixedUnderlying : std::false_type {};
+
+template<class E>
+struct HasFixedUnderlying<E, std::void_t<decltype(E{std::underlying_type_t<E>{}})>> : std::true_type {};
+
+template<class E>
+constexpr auto hasFixedUnderlying = std::conjunction_v<std::is_enum<E>, HasFixedUnderlying<E>>;
+
+// Names reflected from the compiler's pretty function signatures, for types and enums without name()
+//
+// * valueName<V>: name of the enumerator V without qualification, empty for values that are not enumerators
+// * typeName<T>: name of T without namespaces
+// * enumName(v): valueName of the values 0 to enumNameRange - 1 and of single bits, empty for all others
+//   only for enums with a fixed underlying type, other enums can not be cast from all those values
+//
+// All names live in constexpr arrays, nothing is registered or initialized at runtime.
+constexpr auto enumNameRange = size_t{128};
+
+namespace details {
+
+template<auto V>
+constexpr auto prettyValue() noexcept -> std::string_view {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+template<class T>
+constexpr auto prettyType() noexcept -> std::string_view {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+// the template argument of a pretty function
+// gcc: "... [with auto V = ns::E::a; std::string_view = ...]", clang: "... [V = ns::E::a]", msvc: "...<ns::E::a>(void)"
+constexpr auto templateArgument(std::string_view pretty) noexcept -> std::string_view {
+#if defined(_MSC_VER) && !defined(__clang__)
+    const auto end = pretty.rfind(">(");
+    auto depth = 0;
+    auto begin = end;
+    while (begin > 0 && !(pretty[begin - 1] == '<' && depth == 0)) {
+        begin--;
+        if (pretty[begin] == '>') depth++;
+        if (pretty[begin] == '<') depth--;
+    }
+    auto r = pretty.substr(begin, end - begin);
+    for (auto prefix : {std::string_view{"struct "}, std::string_view{"class "}, std::string_view{"enum "}})
+        if (r.substr(0, prefix.size()) == prefix) r.remove_prefix(prefix.size());
+    return r;
+#else
+    const auto begin = pretty.find(" = ") + 3;
+    return pretty.substr(begin, pretty.find_first_of(";]", begin) - begin);
+#endif
+}
+
+// drops namespaces and enclosing scopes, but not those of template arguments
+constexpr auto unqualified(std::string_view name) noexcept -> std::string_view {
+    const auto scope = name.substr(0, name.find('<')).rfind("::");
+    return scope == std::string_view::npos ? name : name.substr(scope + 2);
+}
+
+constexpr auto reflectValue(std::string_view argument) noexcept -> std::string_view {
+    // compilers print other values as a cast or number, like "(E)5"
+    if (argument.empty() || argument[0] == '(' || argument[0] == '-' || (argument[0] >= '0' && argument[0] <= '9'))
+        return {};
+    return unqualified(argument);
+}
+
+// copies a name out of the pretty function text into an array of its own
+template<size_t N>
+constexpr auto nameStorage(std::string_view name) noexcept -> std::array<char, N + 1> {
+    auto r = std::array<char, N + 1>{};
+    for (auto i = size_t{}; i < N; i++) r[i] = name[i];
+    return r;
+}
+
+template<auto V>
+constexpr auto valueNameView = reflectValue(templateArgument(prettyValue<V>()));
+template<auto V>
+constexpr auto valueNameChars = nameStorage<valueNameView<V>.size()>(valueNameView<V>);
+
+template<class T>
+constexpr auto typeNameView = unqualified(templateArgument(prettyType<T>()));
+template<class T>
+constexpr auto typeNameChars = nameStorage<typeNameView<T>.size()>(typeNameView<T>);
+
+} // namespace details
+
+template<auto V>
+constexpr auto valueName = std::string_view{details::valueNameChars<V>.data(), details::valueNameView<V>.size()};
+
+template<class T>
+constexpr auto typeName = std::string_view{details::typeNameChars<T>.data(), details::typeNameView<T>.size()};
+
+namespace details {
+
+template<class E>
+using UnsignedOf = std::make_unsigned_t<std::underlying_type_t<E>>;
+
+template<class E, size_t... I>
+constexpr auto denseNames(std::index_sequence<I...>) noexcept -> std::array<std::string_view, sizeof...(I)> {
+    return {valueName<static_cast<E>(I)>...};
+}
+
+template<class E, size_t... I>
+constexpr auto bitNames(std::index_sequence<I...>) noexcept -> std::array<std::string_view, sizeof...(I)> {
+    return {valueName<static_cast<E>(static_cast<UnsignedOf<E>>(UnsignedOf<E>{1} << I))>...};
+}
+
+template<class E>
+constexpr auto enumNames = denseNames<E>(std::make_index_sequence<enumNameRange>{});
+
+template<class E>
+constexpr auto enumBitNames = bitNames<E>(std::make_index_sequence<sizeof(E) * 8>{});
+
+} // namespace details
+
+// Name of an enum value known only at runtime, see valueName
+// covers the values of repeated and bitnumber flags and the single bit values of classic flags
+template<class E>
+constexpr auto enumName(E v) noexcept -> std::string_view {
+    static_assert(hasFixedUnderlying<E>, "only enums with a fixed underlying type are reflected, declare constexpr name()");
+    const auto u = static_cast<details::UnsignedOf<E>>(v);
+    if (u < enumNameRange) return details::enumNames<E>[u];
+    if ((u & (u - 1)) != 0) return {};
+    auto bit = size_t{};
+    while ((u >> bit) != 1) bit++;
+    return details::enumBitNames<E>[bit];
+}
+
+namespace test {
+
+enum class TE { first, second, big = 1u << 20 };
+enum TU { tu };
+enum TF : int { tf };
+struct TT;
+
+static_assert(hasFixedUnderlying<TE> && hasFixedUnderlying<TF>, "");
+static_assert(!hasFixedUnderlying<TU> && !hasFixedUnderlying<int>, "");
+
+static_assert(valueName<TE::second> == "second", "");
+static_assert(valueName<static_cast<TE>(7)>.empty(), "");
+static_assert(typeName<TT> == "TT", "");
+static_assert(enumName(TE::first) == "first" && enumName(TE::big) == "big", "");
+static_assert(enumName(static_cast<TE>(3)).empty() && enumName(static_cast<TE>(1000)).empty(), "");
+
+} // namespace test
+
 } // namespace meta
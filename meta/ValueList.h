@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <limits>
 #include <utility>
 
 namespace meta {
@@ -26,15 +27,15 @@ constexpr auto commonType() noexcept {
     if constexpr (isSameType<W...>()) return head<W...>();
 }
 
+template<class T, class = void>
+struct UnderlyingType {
+    using type = T;
+};
+
 template<class T>
-constexpr auto underlyingType() noexcept {
-    if constexpr (std::is_enum_v<T>) {
-        return std::underlying_type_t<T>{};
-    }
-    else {
-        return std::declval<T>();
-    }
-}
+struct UnderlyingType<T, std::enable_if_t<std::is_enum_v<T>>> {
+    using type = std::underlying_type_t<T>;
+};
 
 template<auto T, auto... A, size_t... I>
 constexpr auto indexOf(std::index_sequence<I...> = {}) noexcept -> size_t {
@@ -110,7 +111,7 @@ template<auto... V>
 struct ValueList {
     static constexpr bool isSameType = details::isSameType<V...>();
     using commonType = decltype(details::commonType<V...>());
-    using underlyingType = decltype(details::underlyingType<commonType>());
+    using underlyingType = typename details::UnderlyingType<commonType>::type;
 
     using IndexSequence = std::make_index_sequence<sizeof...(V)>;
     static constexpr auto indexSequence = IndexSequence{};
@@ -0,0 +1 @@
+#include "BitKernels.h"
@@ -0,0 +1,184 @@
+#pragma once
+#include <cinttypes>
+#include <cstddef>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// Constant evaluation has to stay on the scalar path.
+// Without the builtin the kernels are disabled entirely.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define META_HAS_CONSTANT_EVALUATED 1
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define META_HAS_CONSTANT_EVALUATED 1
+#endif
+
+#if defined(META_HAS_CONSTANT_EVALUATED) && (defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE4_1__))
+#define META_HAS_BIT_KERNELS 1
+#endif
+
+namespace meta::details {
+
+constexpr bool isConstantEvaluated() noexcept {
+#ifdef META_HAS_CONSTANT_EVALUATED
+    return __builtin_is_constant_evaluated();
+#else
+    return true;
+#endif
+}
+
+// Vector kernels for arrays of N uint64_t words
+// The widest instruction set enabled by -march is picked at compile time.
+// Each kernel walks 512, 256 and 128 bit chunks and finishes with scalar words.
+// Results are bit-identical to the scalar BitStorage operations.
+struct BitKernels {
+    static constexpr bool enabled =
+#ifdef META_HAS_BIT_KERNELS
+        true;
+#else
+        false;
+#endif
+
+    enum class Op { Or, And, Xor };
+
+    // Returns a == b
+    template<size_t N>
+    static bool equal(const uint64_t *a, const uint64_t *b) noexcept;
+
+    // Returns (a & b) != 0
+    template<size_t N>
+    static bool intersects(const uint64_t *a, const uint64_t *b) noexcept;
+
+    // Returns (a & b) == b
+    template<size_t N>
+    static bool contains(const uint64_t *a, const uint64_t *b) noexcept;
+
+    // r = a op b
+    template<Op op, size_t N>
+    static void combine(uint64_t *r, const uint64_t *a, const uint64_t *b) noexcept;
+};
+
+#ifdef META_HAS_BIT_KERNELS
+
+template<size_t N>
+bool BitKernels::equal(const uint64_t *a, const uint64_t *b) noexcept {
+    auto i = size_t{};
+#ifdef __AVX512F__
+    for (; i + 8 <= N; i += 8) {
+        const auto va = _mm512_loadu_si512(a + i);
+        const auto vb = _mm512_loadu_si512(b + i);
+        if (_mm512_cmpneq_epu64_mask(va, vb)) return false;
+    }
+#endif
+#ifdef __AVX2__
+    for (; i + 4 <= N; i += 4) {
+        const auto x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        if (!_mm256_testz_si256(x, x)) return false;
+    }
+#endif
+    for (; i + 2 <= N; i += 2) {
+        const auto x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        if (!_mm_testz_si128(x, x)) return false;
+    }
+    for (; i < N; i++)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+template<size_t N>
+bool BitKernels::intersects(const uint64_t *a, const uint64_t *b) noexcept {
+    auto i = size_t{};
+#ifdef __AVX512F__
+    for (; i + 8 <= N; i += 8) {
+        if (_mm512_test_epi64_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))) return true;
+    }
+#endif
+#ifdef __AVX2__
+    for (; i + 4 <= N; i += 4) {
+        if (!_mm256_testz_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))))
+            return true;
+    }
+#endif
+    for (; i + 2 <= N; i += 2) {
+        if (!_mm_testz_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))))
+            return true;
+    }
+    for (; i < N; i++)
+        if (a[i] & b[i]) return true;
+    return false;
+}
+
+template<size_t N>
+bool BitKernels::contains(const uint64_t *a, const uint64_t *b) noexcept {
+    auto i = size_t{};
+#ifdef __AVX512F__
+    for (; i + 8 <= N; i += 8) {
+        const auto vb = _mm512_loadu_si512(b + i);
+        if (_mm512_cmpneq_epu64_mask(_mm512_and_si512(_mm512_loadu_si512(a + i), vb), vb)) return false;
+    }
+#endif
+#ifdef __AVX2__
+    for (; i + 4 <= N; i += 4) {
+        // testc is set when (~a & b) == 0
+        if (!_mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))))
+            return false;
+    }
+#endif
+    for (; i + 2 <= N; i += 2) {
+        if (!_mm_testc_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))))
+            return false;
+    }
+    for (; i < N; i++)
+        if ((a[i] & b[i]) != b[i]) return false;
+    return true;
+}
+
+template<BitKernels::Op op, size_t N>
+void BitKernels::combine(uint64_t *r, const uint64_t *a, const uint64_t *b) noexcept {
+    auto i = size_t{};
+#ifdef __AVX512F__
+    for (; i + 8 <= N; i += 8) {
+        const auto va = _mm512_loadu_si512(a + i);
+        const auto vb = _mm512_loadu_si512(b + i);
+        if constexpr (op == Op::Or) _mm512_storeu_si512(r + i, _mm512_or_si512(va, vb));
+        if constexpr (op == Op::And) _mm512_storeu_si512(r + i, _mm512_and_si512(va, vb));
+        if constexpr (op == Op::Xor) _mm512_storeu_si512(r + i, _mm512_xor_si512(va, vb));
+    }
+#endif
+#ifdef __AVX2__
+    for (; i + 4 <= N; i += 4) {
+        const auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        const auto vr = reinterpret_cast<__m256i *>(r + i);
+        if constexpr (op == Op::Or) _mm256_storeu_si256(vr, _mm256_or_si256(va, vb));
+        if constexpr (op == Op::And) _mm256_storeu_si256(vr, _mm256_and_si256(va, vb));
+        if constexpr (op == Op::Xor) _mm256_storeu_si256(vr, _mm256_xor_si256(va, vb));
+    }
+#endif
+    for (; i + 2 <= N; i += 2) {
+        const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        const auto vr = reinterpret_cast<__m128i *>(r + i);
+        if constexpr (op == Op::Or) _mm_storeu_si128(vr, _mm_or_si128(va, vb));
+        if constexpr (op == Op::And) _mm_storeu_si128(vr, _mm_and_si128(va, vb));
+        if constexpr (op == Op::Xor) _mm_storeu_si128(vr, _mm_xor_si128(va, vb));
+    }
+    for (; i < N; i++) {
+        if constexpr (op == Op::Or) r[i] = a[i] | b[i];
+        if constexpr (op == Op::And) r[i] = a[i] & b[i];
+        if constexpr (op == Op::Xor) r[i] = a[i] ^ b[i];
+    }
+}
+
+#endif // META_HAS_BIT_KERNELS
+
+} // namespace meta::details
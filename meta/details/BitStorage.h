@@ -1,29 +1,39 @@
 #pragma once
+#include "BitKernels.h"
+
+#include <cinttypes>
 #include <cstddef>
+#include <functional>
+#include <initializer_list>
 #include <limits>
+#include <type_traits>
 #include <utility>
 
 namespace meta::details {
 
-template<class Tag>
-struct BitStorage;
+// Single word storage
+// Word has to be an unsigned integral type
+template<class Word>
+struct BitStorage {
+    static_assert(std::is_unsigned_v<Word>, "BitStorage requires an unsigned word type");
 
-template<>
-struct BitStorage<unsigned int> {
     using This = BitStorage;
     using Index = size_t;
+    using WordType = Word;
+    static constexpr auto wordBits = size_t{std::numeric_limits<Word>::digits};
+    static constexpr auto wordCount = size_t{1};
 
     explicit constexpr BitStorage(Index idx) noexcept
-        : v(1 << idx) {}
+        : v(bit(idx)) {}
 
     template<size_t... I>
     explicit constexpr BitStorage(std::index_sequence<I...>) noexcept
-        : v((0 | ... | (1 << I))) {}
+        : v((Word{} | ... | bit(I))) {}
 
     explicit constexpr BitStorage(std::initializer_list<size_t> i) noexcept
         : v([=] {
-            auto s = size_t{};
-            for (auto v : i) s |= (1 << v);
+            auto s = Word{};
+            for (auto v : i) s |= bit(v);
             return s;
         }()) {}
 
@@ -36,15 +46,25 @@ struct BitStorage<unsigned int> {
     constexpr bool operator==(const This &o) const noexcept { return v == o.v; }
     constexpr bool operator!=(const This &o) const noexcept { return !(*this == o); }
 
+    // total order of the word value, bit i is worth 2^i
+    constexpr bool operator<(const This &o) const noexcept { return v < o.v; }
+    constexpr bool operator>(const This &o) const noexcept { return o < *this; }
+    constexpr bool operator<=(const This &o) const noexcept { return !(o < *this); }
+    constexpr bool operator>=(const This &o) const noexcept { return !(*this < o); }
+
     constexpr bool operator[](Index idx) const noexcept { return (v >> idx) & 1; }
 
+    constexpr bool none() const noexcept { return v == Word{}; }
+    constexpr bool intersects(const This &o) const noexcept { return (v & o.v) != Word{}; }
+    constexpr bool contains(const This &o) const noexcept { return (v & o.v) == o.v; }
+
     constexpr auto set(Index idx) const noexcept -> This { return *this | idx; }
     constexpr auto reset(Index idx) const noexcept -> This { return *this & ~BitStorage{idx}; }
     constexpr auto flip(Index idx) const noexcept -> This { return *this ^ idx; }
 
     constexpr static auto setAll() noexcept -> This {
         auto r = This{};
-        r.v = std::numeric_limits<decltype(v)>::max();
+        r.v = std::numeric_limits<Word>::max();
         return r;
     }
     constexpr static auto resetAll() noexcept -> This { return This{}; }
@@ -52,7 +72,7 @@ struct BitStorage<unsigned int> {
 
     constexpr auto operator~() const noexcept -> This {
         auto r = This{};
-        r.v = ~v;
+        r.v = static_cast<Word>(~v);
         return r;
     }
 
@@ -63,7 +83,7 @@ struct BitStorage<unsigned int> {
     }
     constexpr auto operator|(Index idx) const noexcept -> This {
         auto r = This{};
-        r.v = v | (1 << idx);
+        r.v = v | bit(idx);
         return r;
     }
 
@@ -74,7 +94,7 @@ struct BitStorage<unsigned int> {
     }
     constexpr auto operator&(Index idx) const noexcept -> This {
         auto r = This{};
-        r.v = v & (1 << idx);
+        r.v = v & bit(idx);
         return r;
     }
 
@@ -85,21 +105,206 @@ struct BitStorage<unsigned int> {
     }
     constexpr auto operator^(Index idx) const noexcept -> This {
         auto r = This{};
-        r.v = v ^ (1 << idx);
+        r.v = v ^ bit(idx);
         return r;
     }
 
 private:
-    unsigned int v{};
+    constexpr static auto bit(Index idx) noexcept -> Word { return static_cast<Word>(Word{1} << idx); }
+
+private:
+    Word v{};
 };
 
+// Multi word storage
+// all operations are unrolled over the N words at compile time
+// at runtime uint64_t words use the vector BitKernels if enabled
+template<class Word, size_t N>
+struct BitStorage<Word[N]> {
+    static_assert(std::is_unsigned_v<Word>, "BitStorage requires an unsigned word type");
+    static_assert(N > 0, "BitStorage requires at least one word");
+
+    using This = BitStorage;
+    using Index = size_t;
+    using WordType = Word;
+    static constexpr auto wordBits = size_t{std::numeric_limits<Word>::digits};
+    static constexpr auto wordCount = N;
+
+    explicit constexpr BitStorage(Index idx) noexcept { w[idx / wordBits] = bit(idx); }
+
+    template<size_t... I>
+    explicit constexpr BitStorage(std::index_sequence<I...>) noexcept {
+        ((w[I / wordBits] |= bit(I)), ...);
+    }
+
+    explicit constexpr BitStorage(std::initializer_list<size_t> i) noexcept {
+        for (auto idx : i) w[idx / wordBits] |= bit(idx);
+    }
+
+    constexpr BitStorage() noexcept = default;
+    constexpr BitStorage(const This &) noexcept = default;
+    constexpr BitStorage(This &&) noexcept = default;
+    constexpr auto operator=(const This &) noexcept -> This & = default;
+    constexpr auto operator=(This &&) noexcept -> This & = default;
+
+    constexpr bool operator==(const This &o) const noexcept {
+        if constexpr (useKernels) {
+            if (!isConstantEvaluated()) return BitKernels::equal<N>(w, o.w);
+        }
+        return equal(o, Words{});
+    }
+    constexpr bool operator!=(const This &o) const noexcept { return !(*this == o); }
+
+    // total order of the number formed by all words, the last word is the most significant
+    constexpr bool operator<(const This &o) const noexcept {
+        for (auto i = N; i-- > 0;)
+            if (w[i] != o.w[i]) return w[i] < o.w[i];
+        return false;
+    }
+    constexpr bool operator>(const This &o) const noexcept { return o < *this; }
+    constexpr bool operator<=(const This &o) const noexcept { return !(o < *this); }
+    constexpr bool operator>=(const This &o) const noexcept { return !(*this < o); }
+
+    constexpr bool operator[](Index idx) const noexcept { return (w[idx / wordBits] >> (idx % wordBits)) & 1; }
+
+    constexpr bool none() const noexcept { return !intersects(filled()); }
+    constexpr bool intersects(const This &o) const noexcept {
+        if constexpr (useKernels) {
+            if (!isConstantEvaluated()) return BitKernels::intersects<N>(w, o.w);
+        }
+        return (*this & o) != This{};
+    }
+    constexpr bool contains(const This &o) const noexcept {
+        if constexpr (useKernels) {
+            if (!isConstantEvaluated()) return BitKernels::contains<N>(w, o.w);
+        }
+        return (*this & o) == o;
+    }
+
+    constexpr auto set(Index idx) const noexcept -> This { return *this | idx; }
+    constexpr auto reset(Index idx) const noexcept -> This { return *this & ~BitStorage{idx}; }
+    constexpr auto flip(Index idx) const noexcept -> This { return *this ^ idx; }
+
+    constexpr static auto setAll() noexcept -> This { return ~This{}; }
+    constexpr static auto resetAll() noexcept -> This { return This{}; }
+    constexpr auto flipAll() const noexcept -> This { return ~*this; }
+
+    constexpr auto operator~() const noexcept -> This { return combine<Op::Xor>(filled(), std::bit_xor<Word>{}); }
+
+    constexpr auto operator|(This o) const noexcept -> This { return combine<Op::Or>(o, std::bit_or<Word>{}); }
+    constexpr auto operator|(Index idx) const noexcept -> This {
+        auto r = *this;
+        r.w[idx / wordBits] |= bit(idx);
+        return r;
+    }
+
+    constexpr auto operator&(This o) const noexcept -> This { return combine<Op::And>(o, std::bit_and<Word>{}); }
+    constexpr auto operator&(Index idx) const noexcept -> This {
+        auto r = This{};
+        r.w[idx / wordBits] = w[idx / wordBits] & bit(idx);
+        return r;
+    }
+
+    constexpr auto operator^(This o) const noexcept -> This { return combine<Op::Xor>(o, std::bit_xor<Word>{}); }
+    constexpr auto operator^(Index idx) const noexcept -> This {
+        auto r = *this;
+        r.w[idx / wordBits] ^= bit(idx);
+        return r;
+    }
+
+private:
+    using Words = std::make_index_sequence<N>;
+    using Op = BitKernels::Op;
+    static constexpr bool useKernels = BitKernels::enabled && std::is_same_v<Word, uint64_t> && N >= 2;
+
+    constexpr static auto bit(Index idx) noexcept -> Word { return static_cast<Word>(Word{1} << (idx % wordBits)); }
+
+    template<size_t... I>
+    constexpr bool equal(const This &o, std::index_sequence<I...>) const noexcept {
+        return (true && ... && (w[I] == o.w[I]));
+    }
+
+    template<Op op, class F>
+    constexpr auto combine(const This &o, F f) const noexcept -> This {
+        if constexpr (useKernels) {
+            if (!isConstantEvaluated()) {
+                auto r = This{};
+                BitKernels::combine<op, N>(r.w, w, o.w);
+                return r;
+            }
+        }
+        return combine(o, f, Words{});
+    }
+    template<class F, size_t... I>
+    constexpr auto combine(const This &o, F f, std::index_sequence<I...>) const noexcept -> This {
+        auto r = This{};
+        ((r.w[I] = static_cast<Word>(f(w[I], o.w[I]))), ...);
+        return r;
+    }
+
+    constexpr static auto filled() noexcept -> This {
+        auto r = This{};
+        for (auto &v : r.w) v = std::numeric_limits<Word>::max();
+        return r;
+    }
+
+private:
+    Word w[N]{};
+};
+
+// Returns the smallest unsigned word type with at least bits digits.
+// Anything wider than 64 bits gets a uint64_t (use an array of words).
+template<size_t bits>
+constexpr auto SelectBitWord() {
+    if constexpr (bits <= 8)
+        return uint8_t{};
+    else if constexpr (bits <= 16)
+        return uint16_t{};
+    else if constexpr (bits <= 32)
+        return uint32_t{};
+    else
+        return uint64_t{};
+}
+
+// Layout of the selected storage:
+// * up to 64 bits: a single word of 1, 2, 4 or 8 bytes; size and alignment equal that word
+// * more bits: an array of uint64_t words; size is 8 * words, alignment is alignof(uint64_t)
+// Bit i lives in word i / wordBits at position i % wordBits.
+// There is no padding, so Flags members pack like plain integers of the same size.
 template<size_t bits>
 constexpr auto SelectBitStorage() {
-    constexpr auto bytes = (bits + 7) / 8;
-    if constexpr (bytes <= sizeof(unsigned int)) {
-        return BitStorage<unsigned int>{};
+    if constexpr (bits <= 64) {
+        return BitStorage<decltype(SelectBitWord<bits>())>{};
+    }
+    else {
+        constexpr auto words = (bits + 63) / 64;
+        return BitStorage<uint64_t[words]>{};
     }
-    throw "Not enough bits in an unsigned int (TODO: write additional storage)";
 }
 
+static_assert(BitStorage<uint64_t>{std::index_sequence<0, 63>{}}[63], "");
+static_assert(!BitStorage<uint64_t>{std::index_sequence<0, 63>{}}[62], "");
+static_assert(BitStorage<uint64_t[3]>{std::index_sequence<0, 64, 130>{}}[130], "");
+static_assert(!BitStorage<uint64_t[3]>{std::index_sequence<0, 64, 130>{}}[129], "");
+static_assert(BitStorage<uint64_t[3]>{130}.set(5) == BitStorage<uint64_t[3]>{{5, 130}}, "");
+static_assert(BitStorage<uint64_t[3]>{{5, 130}}.reset(5) == BitStorage<uint64_t[3]>{130}, "");
+static_assert(BitStorage<uint64_t[3]>{{5, 130}}.flip(70) == BitStorage<uint64_t[3]>{{5, 70, 130}}, "");
+static_assert((~BitStorage<uint64_t[3]>{})[191], "");
+static_assert((BitStorage<uint64_t[3]>{{1, 100}} & BitStorage<uint64_t[3]>{100}) == BitStorage<uint64_t[3]>{100}, "");
+static_assert(BitStorage<uint64_t[3]>{{5, 130}}.contains(BitStorage<uint64_t[3]>{130}), "");
+static_assert(!BitStorage<uint64_t[3]>{{5, 130}}.contains(BitStorage<uint64_t[3]>{{5, 129}}), "");
+static_assert(BitStorage<uint64_t[3]>{{5, 130}}.intersects(BitStorage<uint64_t[3]>{{6, 130}}), "");
+static_assert(BitStorage<uint64_t[3]>{}.none() && !BitStorage<uint64_t[3]>{191}.none(), "");
+static_assert(std::is_trivially_copyable_v<BitStorage<uint64_t[3]>>, "");
+static_assert(sizeof(BitStorage<uint64_t[3]>) == 3 * sizeof(uint64_t), "");
+static_assert(sizeof(BitStorage<uint8_t>) == 1 && alignof(BitStorage<uint8_t>) == 1, "");
+static_assert(BitStorage<uint8_t>{7}[7] && (~BitStorage<uint8_t>{}) == BitStorage<uint8_t>::setAll(), "");
+
+static_assert(std::is_same_v<decltype(SelectBitStorage<3>()), BitStorage<uint8_t>>, "");
+static_assert(std::is_same_v<decltype(SelectBitStorage<9>()), BitStorage<uint16_t>>, "");
+static_assert(std::is_same_v<decltype(SelectBitStorage<17>()), BitStorage<uint32_t>>, "");
+static_assert(std::is_same_v<decltype(SelectBitStorage<64>()), BitStorage<uint64_t>>, "");
+static_assert(std::is_same_v<decltype(SelectBitStorage<65>()), BitStorage<uint64_t[2]>>, "");
+static_assert(std::is_same_v<decltype(SelectBitStorage<600>()), BitStorage<uint64_t[10]>>, "");
+
 } // namespace meta::details
@@ -0,0 +1 @@
+#include "CacheLine.h"
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+
+namespace meta::details {
+
+// destructive interference size of all common x86 and arm cores
+// std::hardware_destructive_interference_size is missing or unstable across compilers
+constexpr auto cacheLineSize = size_t{64};
+
+} // namespace meta::details
@@ -0,0 +1,24 @@
+#pragma once
+#include <cinttypes>
+#include <string_view>
+
+namespace meta::details {
+
+constexpr auto fnv1aBasis = uint64_t{14695981039346656037ull};
+
+// 64 bit FNV-1a of the bytes of s, h continues an earlier hash
+constexpr auto fnv1a(std::string_view s, uint64_t h = fnv1aBasis) noexcept -> uint64_t {
+    for (auto c : s) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    return h;
+}
+
+// continues h with the 8 little endian bytes of v
+constexpr auto fnv1a(uint64_t v, uint64_t h) noexcept -> uint64_t {
+    for (auto i = 0; i < 8; i++, v >>= 8) h = (h ^ (v & 0xff)) * 1099511628211ull;
+    return h;
+}
+
+static_assert(fnv1a("") == fnv1aBasis, "");
+static_assert(fnv1a("a") == 0xaf63dc4c8601ec8cull, "FNV-1a test vector");
+
+} // namespace meta::details
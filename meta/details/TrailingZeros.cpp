@@ -0,0 +1 @@
+#include "TrailingZeros.h"
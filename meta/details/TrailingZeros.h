@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+
+namespace meta::details {
+
+// lowest set bit times the de Bruijn sequence puts a unique 6 bit pattern into the top bits
+constexpr auto deBruijn64 = uint64_t{0x03f79d71b4cb0a89ull};
+constexpr auto deBruijnIndex = [] {
+    auto r = std::array<uint8_t, 64>{};
+    for (auto i = 0; i < 64; i++) r[(deBruijn64 << i) >> 58] = static_cast<uint8_t>(i);
+    return r;
+}();
+
+// Returns number of zero bits preceding least significant 1 bit.
+// Undefined for zero value.
+constexpr auto countTrailingZeros(uint64_t v) noexcept -> size_t {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(v));
+#else
+    return deBruijnIndex[((v & (~v + 1)) * deBruijn64) >> 58];
+#endif
+}
+
+static_assert(countTrailingZeros(1) == 0, "");
+static_assert(countTrailingZeros(0x50) == 4, "");
+static_assert(countTrailingZeros(uint64_t{1} << 63) == 63, "");
+
+} // namespace meta::details
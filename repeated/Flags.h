@@ -51,10 +51,16 @@ struct Flags {
     constexpr bool operator==(const This &o) const noexcept { return storage == o.storage; }
     constexpr bool operator!=(const This &o) const noexcept { return !(*this == o); }
 
+    // total order, flags compare like unsigned numbers with bit indexOf(b) worth 2^indexOf(b)
+    constexpr bool operator<(const This &o) const noexcept { return storage < o.storage; }
+    constexpr bool operator>(const This &o) const noexcept { return o < *this; }
+    constexpr bool operator<=(const This &o) const noexcept { return !(o < *this); }
+    constexpr bool operator>=(const This &o) const noexcept { return !(*this < o); }
+
     constexpr bool operator[](EnumType b) const noexcept { return storage[indexOf(b)]; }
 
     constexpr bool all() const noexcept { return all(setAll()); }
-    constexpr bool all(This b) const noexcept { return (storage & b.storage) == b.storage; }
+    constexpr bool all(This b) const noexcept { return storage.contains(b.storage); }
     template<auto B, auto... C>
     constexpr bool all(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf(B)) && ... && (bitCount > indexOf(C))));
@@ -66,7 +72,7 @@ struct Flags {
     }
 
     constexpr bool any() const noexcept { return any(setAll()); }
-    constexpr bool any(This b) const noexcept { return (storage & b.storage) != Storage{}; }
+    constexpr bool any(This b) const noexcept { return storage.intersects(b.storage); }
     template<auto B, auto... C>
     constexpr bool any(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf(B)) && ... && (bitCount > indexOf(C))));
@@ -77,8 +83,8 @@ struct Flags {
         return any(build(b, args...));
     }
 
-    constexpr bool none() const noexcept { return any(setAll()); }
-    constexpr bool none(This b) const noexcept { return (storage & b.storage) == Storage{}; }
+    constexpr bool none() const noexcept { return storage.none(); }
+    constexpr bool none(This b) const noexcept { return !storage.intersects(b.storage); }
     template<auto B, auto... C>
     constexpr bool none(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf(B)) && ... && (bitCount > indexOf(C))));
@@ -227,6 +233,16 @@ static_assert((Flags<TE::n1, TE::n2, TE::n3>{}.set(TE::n1, TE::n3) & FlagList<TE
               "");
 static_assert(Flags<TE::n1, TE::n2, TE::n3>{}.flip(TE::n2, TE::n3).any(TE::n1, TE::n2), "");
 static_assert((Flags<TE::n1, TE::n2, TE::n3>::setAll() & TE::n2) == FlagList<TE::n2>{}, "not all set");
+static_assert(sizeof(Flags<TE::n1, TE::n2, TE::n3>) == 1, "5 bits should fit into a single byte");
+
+enum class Wide { first, mid = 70, last = 149 };
+static_assert(Flags<Wide::first, Wide::mid, Wide::last>{Wide::last}[Wide::last], "");
+static_assert(!Flags<Wide::first, Wide::mid, Wide::last>{Wide::last}[Wide::mid], "");
+static_assert((Flags<Wide::first, Wide::mid, Wide::last>{}.set(Wide::first, Wide::last) & FlagList<Wide::last>{}) ==
+                  FlagList<Wide::last>{},
+              "");
+static_assert(Flags<Wide::first, Wide::mid, Wide::last>{}.flip(Wide::mid).any(Wide::mid, Wide::last), "");
+static_assert(sizeof(Flags<Wide::first, Wide::mid, Wide::last>) == 3 * sizeof(uint64_t), "150 bits use 3 words");
 
 } // namespace test
 
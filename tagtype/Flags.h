@@ -53,6 +53,12 @@ struct Flags {
     constexpr bool operator==(const This &o) const noexcept { return storage == o.storage; }
     constexpr bool operator!=(const This &o) const noexcept { return !(*this == o); }
 
+    // total order, flags compare like unsigned numbers with bit indexOf(b) worth 2^indexOf(b)
+    constexpr bool operator<(const This &o) const noexcept { return storage < o.storage; }
+    constexpr bool operator>(const This &o) const noexcept { return o < *this; }
+    constexpr bool operator<=(const This &o) const noexcept { return !(o < *this); }
+    constexpr bool operator>=(const This &o) const noexcept { return !(*this < o); }
+
     template<class B>
     constexpr bool operator[](Flag<B>) const noexcept {
         constexpr auto index = indexOf<B>();
@@ -61,7 +67,7 @@ struct Flags {
     }
 
     constexpr bool all() const noexcept { return all(setAll()); }
-    constexpr bool all(This b) const noexcept { return (storage & b.storage) == b.storage; }
+    constexpr bool all(This b) const noexcept { return storage.contains(b.storage); }
     template<class B, class... C>
     constexpr bool all(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -73,7 +79,7 @@ struct Flags {
     }
 
     constexpr bool any() const noexcept { return any(setAll()); }
-    constexpr bool any(This b) const noexcept { return (storage & b.storage) != Storage{}; }
+    constexpr bool any(This b) const noexcept { return storage.intersects(b.storage); }
     template<class B, class... C>
     constexpr bool any(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -84,8 +90,8 @@ struct Flags {
         return any<B, C...>();
     }
 
-    constexpr bool none() const noexcept { return any(setAll()); }
-    constexpr bool none(This b) const noexcept { return (storage & b.storage) == Storage{}; }
+    constexpr bool none() const noexcept { return storage.none(); }
+    constexpr bool none(This b) const noexcept { return !storage.intersects(b.storage); }
     template<class B, class... C>
     constexpr bool none(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -224,6 +230,8 @@ static_assert((Flags<int, float>{} | Flag<int>{}) == Flag<int>{}, "");
 static_assert((Flags<char, int, float>{}.set<int, float>() & FlagList<char, int>{}) == Flag<int>{}, "");
 static_assert(Flags<char, int, float>{}.flip<int, float>().any(Flag<char>{}, Flag<int>{}), "");
 static_assert((Flags<char, int, float>::setAll() & Flag<int>{}) == Flag<int>{}, "not all set");
+static_assert(Flags<char, int, float>{}.none() && !Flags<char, int, float>{Flag<int>{}}.none(), "");
+static_assert(sizeof(Flags<char, int, float>) == 1, "3 flags should fit into a single byte");
 
 template<class Out, class A>
 auto operator<<(Out &out, Flag<A>) -> Out & {
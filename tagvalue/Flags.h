@@ -54,6 +54,12 @@ struct Flags {
     constexpr bool operator==(const This &o) const noexcept { return storage == o.storage; }
     constexpr bool operator!=(const This &o) const noexcept { return !(*this == o); }
 
+    // total order, flags compare like unsigned numbers with bit indexOf(b) worth 2^indexOf(b)
+    constexpr bool operator<(const This &o) const noexcept { return storage < o.storage; }
+    constexpr bool operator>(const This &o) const noexcept { return o < *this; }
+    constexpr bool operator<=(const This &o) const noexcept { return !(o < *this); }
+    constexpr bool operator>=(const This &o) const noexcept { return !(*this < o); }
+
     template<auto B>
     constexpr bool operator[](Flag<B>) const noexcept {
         constexpr auto index = indexOf<B>();
@@ -62,7 +68,7 @@ struct Flags {
     }
 
     constexpr bool all() const noexcept { return all(setAll()); }
-    constexpr bool all(This b) const noexcept { return (storage & b.storage) == b.storage; }
+    constexpr bool all(This b) const noexcept { return storage.contains(b.storage); }
     template<auto B, auto... C>
     constexpr bool all(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -74,7 +80,7 @@ struct Flags {
     }
 
     constexpr bool any() const noexcept { return any(setAll()); }
-    constexpr bool any(This b) const noexcept { return (storage & b.storage) != Storage{}; }
+    constexpr bool any(This b) const noexcept { return storage.intersects(b.storage); }
     template<auto B, auto... C>
     constexpr bool any(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -85,8 +91,8 @@ struct Flags {
         return any<B, C...>();
     }
 
-    constexpr bool none() const noexcept { return any(setAll()); }
-    constexpr bool none(This b) const noexcept { return (storage & b.storage) == Storage{}; }
+    constexpr bool none() const noexcept { return storage.none(); }
+    constexpr bool none(This b) const noexcept { return !storage.intersects(b.storage); }
     template<auto B, auto... C>
     constexpr bool none(FlagList<B, C...> b = {}) const noexcept {
         static_assert(((bitCount > indexOf<B>()) && ... && (bitCount > indexOf<C>())));
@@ -225,6 +231,7 @@ static_assert((Flags<1, 2>{} | Flag<1>{}) == Flag<1>{}, "");
 static_assert((Flags<1, 2, 3>{}.set<1, 3>() & FlagList<1, 2>{}) == Flag<1>{}, "");
 static_assert(Flags<1, 2, 3>{}.flip<2, 3>().any(Flag<1>{}, Flag<2>{}), "");
 static_assert((Flags<1, 2, 3>::setAll() & Flag<2>{}) == Flag<2>{}, "not all set");
+static_assert(sizeof(Flags<1, 2, 3>) == 1, "3 flags should fit into a single byte");
 
 template<class T>
 struct Typed {
@@ -0,0 +1,7 @@
+#include "Format.h"
+
+namespace text {
+
+// TODO
+
+} // namespace text
@@ -0,0 +1,166 @@
+#pragma once
+#include "Names.h"
+
+#include "bitnumber/Flags.h"
+#include "classic/Flags.h"
+#include "meta/details/BitStorage.h"
+#include "meta/details/TrailingZeros.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace text {
+
+namespace details {
+
+template<class F, class = void>
+struct HasFlagTable : std::false_type {};
+
+template<class F>
+struct HasFlagTable<F, std::void_t<decltype(FlagTable<F>::size)>> : std::true_type {};
+
+constexpr auto separator = std::string_view{" | "};
+constexpr auto noneText = std::string_view{"<None>"};
+
+using meta::details::countTrailingZeros;
+
+inline auto append(char *first, char *last, const char *s, size_t n) noexcept -> char * {
+    if (first == nullptr || static_cast<size_t>(last - first) < n) return nullptr;
+    std::memcpy(first, s, n);
+    return first + n;
+}
+
+} // namespace details
+
+// Names of a flags type laid out for formatting
+// Every name is stored with a leading " | " in a slot of stride bytes, so a flag costs a single copy of fixed size.
+// The first flag skips the separator.
+template<class F>
+struct FormatTable {
+    using Names = FlagTable<F>;
+    static constexpr auto size = Names::size;
+    static constexpr auto longest = [] {
+        auto r = size_t{};
+        for (auto name : Names::names) r = std::max(r, details::separator.size() + name.size());
+        return r;
+    }();
+    static constexpr auto stride = details::powerOfTwo(longest);
+    // slots up to this size are copied whole when the buffer has room, longer ones byte exact
+    static constexpr auto wholeCopy = stride <= 32;
+
+    // name i with its separator starts at text[i * stride], one more slot pads whole copies that skip the separator
+    static constexpr auto text = [] {
+        auto r = std::array<char, (size + 1) * stride>{};
+        for (auto i = size_t{}; i < size; i++) {
+            auto at = i * stride;
+            for (auto c : details::separator) r[at++] = c;
+            for (auto c : Names::names[i]) r[at++] = c;
+        }
+        return r;
+    }();
+    static constexpr auto lengths = [] {
+        auto r = std::array<uint32_t, size>{};
+        for (auto i = size_t{}; i < size; i++)
+            r[i] = static_cast<uint32_t>(details::separator.size() + Names::names[i].size());
+        return r;
+    }();
+    // bit i is set for every named flag, format_to skips the gaps and unlisted values
+    static constexpr auto members = [] {
+        auto r = std::array<uint64_t, (sizeof(F) + 7) / 8>{};
+        for (auto i = size_t{}; i < size; i++)
+            if (!Names::names[i].empty()) r[i / 64] |= uint64_t{1} << (i % 64);
+        return r;
+    }();
+    // longest text of any value, all flags set
+    static constexpr auto maxSize = [] {
+        auto r = size_t{};
+        for (auto i = size_t{}; i < size; i++)
+            if (!Names::names[i].empty()) r += lengths[i];
+        return std::max(r, details::separator.size() + details::noneText.size()) - details::separator.size();
+    }();
+};
+
+namespace details {
+
+// flags as 64 bit words, bit i of word k is flag index k * 64 + i on every byte order
+template<class F>
+auto flagWords(F f) noexcept -> std::array<uint64_t, (sizeof(F) + 7) / 8> {
+    using Word = decltype(meta::details::SelectBitWord<(sizeof(F) < 8 ? sizeof(F) : 8) * 8>());
+    auto w = std::array<Word, sizeof(F) / sizeof(Word)>{};
+    std::memcpy(w.data(), &f, sizeof(F));
+    auto r = std::array<uint64_t, (sizeof(F) + 7) / 8>{};
+    for (auto k = size_t{}; k < w.size(); k++) r[k] = w[k];
+    return r;
+}
+
+// calls fn(index) for every set member flag, in index order
+template<class F, class Fn>
+void eachSetIndex(F f, Fn &&fn) noexcept {
+    constexpr auto &members = FormatTable<F>::members;
+    const auto w = flagWords(f);
+    for (auto k = size_t{}; k < w.size(); k++)
+        for (auto v = w[k] & members[k]; v != 0; v &= v - 1) fn(k * 64 + countTrailingZeros(v));
+}
+
+} // namespace details
+
+// Number of chars format_to writes for f
+template<class F>
+auto formatted_size(F f) noexcept -> size_t {
+    auto r = size_t{};
+    if constexpr (details::HasFlagTable<F>::value) {
+        using Table = FormatTable<F>;
+        details::eachSetIndex(f, [&](size_t b) { r += Table::lengths[b]; });
+    }
+    else {
+        f.each_set([&](auto flag) { r += details::separator.size() + details::nameOf(flag).size(); });
+    }
+    return r == 0 ? details::noneText.size() : r - details::separator.size();
+}
+
+// Writes the text of operator<< ("Cat | Dog" or "<None>") into [first, last)
+// Returns the end of the text, or nullptr when it does not fit. Nothing is allocated and no terminator is written,
+// bytes between the end and last may be overwritten.
+//
+//     char buffer[text::FormatTable<Animals>::maxSize];
+//     auto end = text::format_to(buffer, buffer + sizeof(buffer), animals);
+//
+// tagtype, tagvalue and repeated flags copy their names from a FormatTable built at compile time.
+// classic and bitnumber flags only know their flags at runtime, every set flag calls its constexpr name().
+template<class F>
+auto format_to(char *first, char *last, F f) noexcept -> char * {
+    const auto start = first;
+    if constexpr (details::HasFlagTable<F>::value) {
+        using Table = FormatTable<F>;
+        auto skip = details::separator.size();
+        details::eachSetIndex(f, [&](size_t b) {
+            const auto from = Table::text.data() + b * Table::stride + skip;
+            const auto length = Table::lengths[b] - skip;
+            skip = 0;
+            if constexpr (Table::wholeCopy) {
+                if (first != nullptr && static_cast<size_t>(last - first) >= Table::stride) {
+                    std::memcpy(first, from, Table::stride);
+                    first += length;
+                    return;
+                }
+            }
+            first = details::append(first, last, from, length);
+        });
+    }
+    else {
+        f.each_set([&](auto flag) {
+            if (first != start) first = details::append(first, last, details::separator.data(), details::separator.size());
+            const auto name = details::nameOf(flag);
+            first = details::append(first, last, name.data(), name.size());
+        });
+    }
+    if (first == start) return details::append(first, last, details::noneText.data(), details::noneText.size());
+    return first;
+}
+
+} // namespace text
@@ -0,0 +1,7 @@
+#include "Literal.h"
+
+namespace text {
+
+// TODO
+
+} // namespace text
@@ -0,0 +1,67 @@
+#pragma once
+#include "Parse.h"
+
+#include <string_view>
+
+namespace text {
+
+// Flags text known at compile time, converts to any flags type that has all the names
+// An unknown name fails the static_assert where the conversion is instantiated, nothing is parsed at runtime.
+template<char... C>
+struct FlagsLiteral {
+    static constexpr char chars[] = {C..., '\0'};
+    static constexpr auto text = std::string_view{chars, sizeof...(C)};
+
+    template<class F>
+    static constexpr auto to() noexcept -> F {
+        constexpr auto r = parse<F>(text);
+        static_assert(bool{r}, "unknown flag name or malformed flags text");
+        return r.value;
+    }
+
+    template<class F>
+    constexpr operator F() const noexcept {
+        return to<F>();
+    }
+};
+
+namespace literals {
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+
+// "Cat | Dog"_flags converts to the flags type it is assigned to, checked at compile time
+//
+//     using namespace text::literals;
+//     constexpr Animals pets = "Cat | Dog"_flags;
+//     if (f == "Wolf"_flags) ...
+//
+// String literal operator templates are a GNU extension (gcc and clang), elsewhere use FlagsLiteral directly.
+template<class T, T... C>
+constexpr auto operator""_flags() noexcept -> FlagsLiteral<C...> {
+    static_assert(std::is_same_v<T, char>, "use narrow string literals for flags");
+    return {};
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace literals
+
+namespace test {
+
+static_assert(FlagsLiteral<'C', 'a', 't', '|', 'W', 'o', 'l', 'f'>::to<TEFlags>() == TEFlags{TE::cat, TE::wolf}, "");
+
+#if defined(__GNUC__)
+using namespace literals;
+static_assert(TEFlags{"Dog"_flags} == TEFlags{TE::dog}, "");
+static_assert(TEFlags{TE::dog} == "Dog"_flags, "");
+#endif
+
+} // namespace test
+
+} // namespace text
@@ -0,0 +1,7 @@
+#include "Names.h"
+
+namespace text {
+
+// TODO
+
+} // namespace text
@@ -0,0 +1,210 @@
+#pragma once
+#include "meta/Name.h"
+#include "meta/details/Hash.h"
+#include "repeated/Flags.h"
+#include "tagtype/Flags.h"
+#include "tagvalue/Flags.h"
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+namespace text {
+
+namespace details {
+
+// Name of a flag, declared next to the flag as constexpr name(v) returning something convertible to std::string_view
+// Enums with a fixed underlying type and without name() fall back to the name of their enumerator (see meta::enumName).
+template<class T>
+constexpr auto nameOf(T v) noexcept -> std::string_view {
+    if constexpr (meta::hasName<T>) {
+        using meta::name;
+        return std::string_view{name(v)};
+    }
+    else {
+        static_assert(meta::hasFixedUnderlying<T>,
+                      "declare constexpr name() for every flag that is not an enum with a fixed underlying type");
+        return meta::enumName(v);
+    }
+}
+
+// tagvalue flags of types without a namespace (like int) are named through name(tagvalue::Flag<V>)
+template<auto V>
+constexpr auto valueName() noexcept -> std::string_view {
+    if constexpr (std::is_same_v<decltype(V), std::nullptr_t>)
+        return {};
+    else if constexpr (meta::hasName<decltype(V)>)
+        return nameOf(V);
+    else if constexpr (meta::hasName<tagvalue::Flag<V>> || !std::is_enum_v<decltype(V)>)
+        return nameOf(tagvalue::Flag<V>{});
+    else
+        return meta::valueName<V>;
+}
+
+// tagtype flags without name(tagtype::Flag<T>) are named like the type T
+template<class T>
+constexpr auto typeName() noexcept -> std::string_view {
+    if constexpr (std::is_same_v<T, void>)
+        return {};
+    else if constexpr (meta::hasName<tagtype::Flag<T>>)
+        return nameOf(tagtype::Flag<T>{});
+    else
+        return meta::typeName<T>;
+}
+
+// flags with only flag V or T set, empty for the gaps
+template<class F, auto V>
+constexpr auto valueFlag() noexcept -> F {
+    if constexpr (std::is_same_v<decltype(V), std::nullptr_t>)
+        return {};
+    else
+        return F{tagvalue::Flag<V>{}};
+}
+
+template<class F, class T>
+constexpr auto typeFlag() noexcept -> F {
+    if constexpr (std::is_same_v<T, void>)
+        return {};
+    else
+        return F{tagtype::Flag<T>{}};
+}
+
+} // namespace details
+
+// Names and single flag values of a flags type by flag index, skipped indices have an empty name
+//
+// * repeated: constexpr name(EnumType), called for every listed value, the values between them are skipped
+// * tagvalue: constexpr name(decltype(V)) or name(tagvalue::Flag<V>)
+// * tagtype: constexpr name(tagtype::Flag<T>)
+// Without name() the enumerator or type name is reflected (see meta/Name.h).
+template<class F>
+struct FlagTable;
+
+template<auto... A>
+struct FlagTable<repeated::Flags<A...>> {
+    using Flags = repeated::Flags<A...>;
+    static constexpr auto size = size_t{Flags::bitCount};
+    static constexpr auto listed = std::array<typename Flags::EnumType, sizeof...(A)>{A...};
+    static constexpr auto names = [] {
+        auto r = std::array<std::string_view, size>{};
+        for (auto &n : r) n = {}; // gcc rejects reading elements that were only default initialized
+        for (auto v : listed) r[Flags::indexOf(v)] = details::nameOf(v);
+        return r;
+    }();
+    static constexpr auto flags = [] {
+        auto r = std::array<Flags, size>{};
+        for (auto v : listed) r[Flags::indexOf(v)] = Flags{v};
+        return r;
+    }();
+};
+
+template<auto... A>
+struct FlagTable<tagvalue::Flags<A...>> {
+    using Flags = tagvalue::Flags<A...>;
+    static constexpr auto size = size_t{Flags::bitCount};
+    static constexpr auto names = std::array<std::string_view, size>{details::valueName<A>()...};
+    static constexpr auto flags = std::array<Flags, size>{details::valueFlag<Flags, A>()...};
+};
+
+template<class... A>
+struct FlagTable<tagtype::Flags<A...>> {
+    using Flags = tagtype::Flags<A...>;
+    static constexpr auto size = size_t{Flags::bitCount};
+    static constexpr auto names = std::array<std::string_view, size>{details::typeName<A>()...};
+    static constexpr auto flags = std::array<Flags, size>{details::typeFlag<Flags, A>()...};
+};
+
+namespace details {
+
+using meta::details::fnv1a;
+
+constexpr auto mixSlot(uint64_t h, uint32_t displacement) noexcept -> uint64_t {
+    h ^= displacement * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    return h ^ (h >> 33);
+}
+
+constexpr auto powerOfTwo(size_t n) noexcept -> size_t {
+    auto r = size_t{1};
+    while (r < n) r *= 2;
+    return r;
+}
+
+} // namespace details
+
+// Perfect hash of N names built at compile time (hash and displace)
+// Every name hashes to a bucket, every bucket has a displacement that moves its names to free slots.
+// A lookup hashes the text once, mixes in the displacement of its bucket and compares one name.
+template<size_t N>
+struct NameIndex {
+    static constexpr auto npos = ~size_t{};
+    static constexpr auto slotCount = details::powerOfTwo(2 * N);
+    static constexpr auto bucketCount = details::powerOfTwo(N / 4 + 1);
+
+    std::array<std::string_view, N> names{};
+    std::array<uint32_t, bucketCount> displacement{};
+    std::array<uint32_t, slotCount> slots{}; // index + 1, 0 for an empty slot
+    bool valid{};                            // false for duplicate names
+
+    constexpr NameIndex() noexcept = default;
+    constexpr explicit NameIndex(const std::array<std::string_view, N> &list) noexcept
+        : names(list) {
+        for (auto i = size_t{}; i < N; i++)
+            for (auto j = i + 1; j < N; j++)
+                if (!names[i].empty() && names[i] == names[j]) return;
+
+        auto buckets = std::array<size_t, N>{};
+        auto sizes = std::array<size_t, bucketCount>{};
+        for (auto i = size_t{}; i < N; i++) {
+            if (names[i].empty()) continue;
+            buckets[i] = details::fnv1a(names[i]) & (bucketCount - 1);
+            sizes[buckets[i]]++;
+        }
+        // largest buckets first, they are the hardest to place
+        for (auto size = N; size > 0; size--) {
+            for (auto b = size_t{}; b < bucketCount; b++) {
+                if (sizes[b] != size) continue;
+                if (!place(b, buckets)) return;
+            }
+        }
+        valid = true;
+    }
+
+    constexpr auto find(std::string_view name) const noexcept -> size_t {
+        const auto h = details::fnv1a(name);
+        const auto i = slots[details::mixSlot(h, displacement[h & (bucketCount - 1)]) & (slotCount - 1)];
+        return i != 0 && names[i - 1] == name ? i - 1 : npos;
+    }
+
+private:
+    constexpr bool place(size_t bucket, const std::array<size_t, N> &buckets) noexcept {
+        for (auto d = uint32_t{}; d < (1u << 20); d++) {
+            auto taken = std::array<size_t, N>{};
+            auto count = size_t{};
+            auto fits = true;
+            for (auto i = size_t{}; fits && i < N; i++) {
+                if (names[i].empty() || buckets[i] != bucket) continue;
+                const auto s = details::mixSlot(details::fnv1a(names[i]), d) & (slotCount - 1);
+                fits = slots[s] == 0;
+                for (auto k = size_t{}; fits && k < count; k++) fits = taken[k] != s;
+                taken[count++] = s;
+            }
+            if (!fits) continue;
+            displacement[bucket] = d;
+            auto k = size_t{};
+            for (auto i = size_t{}; i < N; i++)
+                if (!names[i].empty() && buckets[i] == bucket) slots[taken[k++]] = static_cast<uint32_t>(i + 1);
+            return true;
+        }
+        return false;
+    }
+};
+
+// Compile time name index of a flags type
+template<class F>
+constexpr auto nameIndex = NameIndex<FlagTable<F>::size>{FlagTable<F>::names};
+
+} // namespace text
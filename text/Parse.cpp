@@ -0,0 +1,7 @@
+#include "Parse.h"
+
+namespace text {
+
+// TODO
+
+} // namespace text
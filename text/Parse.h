@@ -0,0 +1,88 @@
+#pragma once
+#include "Names.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace text {
+
+// Result of parse, error is the offset of the first malformed token or npos
+template<class F>
+struct ParseResult {
+    static constexpr auto npos = ~size_t{};
+
+    F value{};
+    size_t error{npos};
+
+    constexpr explicit operator bool() const noexcept { return error == npos; }
+};
+
+namespace details {
+
+constexpr bool isBlank(char c) noexcept { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+constexpr auto skipBlanks(std::string_view text, size_t at) noexcept -> size_t {
+    while (at < text.size() && isBlank(text[at])) at++;
+    return at;
+}
+
+} // namespace details
+
+// Parses the text of operator<< back into flags: names separated by '|', or <None> for no flags
+// Blanks around names are ignored. Every name costs one hash and one string compare (see NameIndex).
+//
+//     auto r = text::parse<Animals>("Cat | Dog");
+//     if (!r) std::cerr << "unknown flag at " << r.error;
+template<class F>
+constexpr auto parse(std::string_view text) noexcept -> ParseResult<F> {
+    static_assert(nameIndex<F>.valid, "duplicate flag names");
+    constexpr auto none = std::string_view{"<None>"};
+    auto r = ParseResult<F>{};
+    auto at = details::skipBlanks(text, 0);
+    if (text.substr(at, none.size()) == none) {
+        at = details::skipBlanks(text, at + none.size());
+        if (at != text.size()) r.error = at;
+        return r;
+    }
+    while (true) {
+        auto end = at;
+        while (end < text.size() && text[end] != '|' && !details::isBlank(text[end])) end++;
+        const auto i = nameIndex<F>.find(text.substr(at, end - at));
+        if (i == NameIndex<0>::npos) {
+            r.error = at;
+            return r;
+        }
+        r.value = r.value | FlagTable<F>::flags[i];
+        at = details::skipBlanks(text, end);
+        if (at == text.size()) return r;
+        if (text[at] != '|') {
+            r.error = at;
+            return r;
+        }
+        at = details::skipBlanks(text, at + 1);
+    }
+}
+
+namespace test {
+
+enum class TE { cat, dog, wolf = 3 };
+constexpr auto name(TE v) noexcept -> std::string_view {
+    switch (v) {
+    case TE::cat: return "Cat";
+    case TE::dog: return "Dog";
+    case TE::wolf: return "Wolf";
+    }
+    return {};
+}
+using TEFlags = repeated::Flags<TE::cat, TE::dog, TE::wolf>;
+
+static_assert(parse<TEFlags>("Cat | Wolf").value == TEFlags{TE::cat, TE::wolf}, "");
+static_assert(parse<TEFlags>("<None>") && parse<TEFlags>("<None>").value == TEFlags{}, "");
+static_assert(parse<TEFlags>("Cat|Cow").error == 4, "unknown name");
+static_assert(parse<TEFlags>("Cat Dog").error == 4, "missing separator");
+static_assert(parse<TEFlags>("Cat |").error == 5, "missing name");
+static_assert(parse<repeated::Flags<TE::cat, TE::wolf>>("Dog").error == 0, "not a listed flag");
+
+} // namespace test
+
+} // namespace text